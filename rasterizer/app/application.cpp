@@ -12,11 +12,22 @@
 #include <iostream>
 #include <memory>
 #include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <filesystem>
 
 
 namespace rasterization {
     static gl::gl_api& core = gl::gl_api::get();
 
+    // a file's size and write time, a cache baked from the file is stale once they change
+    static uint64_t _file_fingerprint(const std::filesystem::path& path) noexcept {
+        std::error_code error;
+        const uint64_t size = std::filesystem::file_size(path, error);
+        const uint64_t time = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+        return size ^ (time * 0x9E3779B97F4A7C15ull);
+    }
+
     struct Vertex {
         math::vec3f position;
         math::color color;
@@ -34,9 +45,13 @@ namespace rasterization {
         assert(core.is_window_binded());
 
         core.viewport(width, height);
+        core.set_shading_mode(shading_mode::GBUFFER);
+        core.set_sample_count(4);
 
-        m_window->SetResizeCallback([](uint32_t width, uint32_t height) {
-            core.viewport(width, height);
+        m_window->SetResizeCallback([this](uint32_t width, uint32_t height) {
+            m_resized = true;
+            m_resized_width = width;
+            m_resized_height = height;
         });
 
         const Vertex triangle[] = {
@@ -44,14 +59,16 @@ namespace rasterization {
             { { 0.5f, -0.5f, 0.0f}, color::GREEN },
             { { 0.0f,  0.5f, 0.0f}, color::BLUE },
         };
-        const size_t triangle_indexes[] = { 0, 1, 2, 0 };
+        const uint16_t triangle_indexes[] = { 0, 1, 2, 0 };
 
         m_objects["triangle"] = {
             core.create_vertex_buffer(triangle, sizeof(triangle)),
-            core.create_index_buffer(triangle_indexes, sizeof(triangle_indexes) / sizeof(triangle_indexes[0]))
+            core.create_index_buffer(triangle_indexes, sizeof(triangle_indexes) / sizeof(triangle_indexes[0]), index_format::UINT16)
         };
         core.bind_buffer(buffer_type::VERTEX, m_objects["triangle"].vbo);
         core.set_buffer_element_size(sizeof(triangle[0]));
+        core.set_vertex_attribute(SimpleShader::IN_POSITION, 3, attribute_type::FLOAT, offsetof(Vertex, position));
+        core.set_vertex_attribute(SimpleShader::IN_COLOR, 4, attribute_type::FLOAT, offsetof(Vertex, color));
 
 
         m_camera_position = 2.5f * vec3f::FORWARD();
@@ -72,22 +89,37 @@ namespace rasterization {
         core.uniform(m_camera_position, "camera_position");
         core.uniform(1.0f, "light_intensity");
         core.uniform(color::WHITE, "light_color");
-        core.uniform(color::TANGERINE, "polygon_color");
         core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
         core.uniform(m_view_matrix, "view");
         core.uniform(m_proj_matrix, "projection");
 
+        const point_light lights[] = {
+            { m_light_position, 30.0f, color::WHITE, 1.0f },
+            { 2.0f * vec3f::BACKWARD() + 3.0f * vec3f::LEFT(), 6.0f, color::RED, 0.8f },
+            { 2.0f * vec3f::FORWARD() + 2.0f * vec3f::UP(), 6.0f, color::BLUE, 0.8f },
+        };
+        core.set_point_lights(lights, sizeof(lights) / sizeof(lights[0]));
+
 
         try {
+            // the layout GouraudShader reads the meshes with
+            const auto set_mesh_vertex_layout = []() {
+                core.set_vertex_attribute(GouraudShader::IN_POSITION, 3, attribute_type::FLOAT, offsetof(Mesh::Vertex, position));
+                core.set_vertex_attribute(GouraudShader::IN_NORMAL, 3, attribute_type::FLOAT, offsetof(Mesh::Vertex, normal));
+                core.set_vertex_attribute(GouraudShader::IN_TEXCOORD, 2, attribute_type::FLOAT, offsetof(Mesh::Vertex, texcoord));
+            };
+
             Mesh head("..\\..\\..\\rasterizer\\app\\assets\\human.obj");
             const Mesh::Content* head_buffer = head.GetContent();
             
             m_objects["head"] = {
                 core.create_vertex_buffer(head_buffer->vertexes.data(), head_buffer->vertexes.size() * sizeof(head_buffer->vertexes[0])),
-                core.create_index_buffer(head_buffer->indexes.data(), head_buffer->indexes.size())
+                core.create_index_buffer(head_buffer->indexes.data(), head_buffer->indexes.size(), index_format::UINT32)
             };
             core.bind_buffer(buffer_type::VERTEX, m_objects["head"].vbo);
             core.set_buffer_element_size(sizeof(head_buffer->vertexes[0]));
+            core.set_buffer_bounds(head_buffer->bounds_min, head_buffer->bounds_max);
+            set_mesh_vertex_layout();
 
 
 
@@ -97,10 +129,12 @@ namespace rasterization {
             
             m_objects["suzanne"] = {
                 core.create_vertex_buffer(suzanne_buffer->vertexes.data(), suzanne_buffer->vertexes.size() * sizeof(suzanne_buffer->vertexes[0])),
-                core.create_index_buffer(suzanne_buffer->indexes.data(), suzanne_buffer->indexes.size())
+                core.create_index_buffer(suzanne_buffer->indexes.data(), suzanne_buffer->indexes.size(), index_format::UINT32)
             };
             core.bind_buffer(buffer_type::VERTEX, m_objects["suzanne"].vbo);
             core.set_buffer_element_size(sizeof(suzanne_buffer->vertexes[0]));
+            core.set_buffer_bounds(suzanne_buffer->bounds_min, suzanne_buffer->bounds_max);
+            set_mesh_vertex_layout();
 
 
             
@@ -110,10 +144,12 @@ namespace rasterization {
 
             m_objects["cube"] = {
                 core.create_vertex_buffer(cube_buffer->vertexes.data(), cube_buffer->vertexes.size() * sizeof(cube_buffer->vertexes[0])),
-                core.create_index_buffer(cube_buffer->indexes.data(), cube_buffer->indexes.size())
+                core.create_index_buffer(cube_buffer->indexes.data(), cube_buffer->indexes.size(), index_format::UINT32)
             };
             core.bind_buffer(buffer_type::VERTEX, m_objects["cube"].vbo);
             core.set_buffer_element_size(sizeof(cube_buffer->vertexes[0]));
+            core.set_buffer_bounds(cube_buffer->bounds_min, cube_buffer->bounds_max);
+            set_mesh_vertex_layout();
 
 
             
@@ -123,25 +159,46 @@ namespace rasterization {
             
             m_objects["diablo"] = {
                 core.create_vertex_buffer(diablo_buffer->vertexes.data(), diablo_buffer->vertexes.size() * sizeof(diablo_buffer->vertexes[0])),
-                core.create_index_buffer(diablo_buffer->indexes.data(), diablo_buffer->indexes.size())
+                core.create_index_buffer(diablo_buffer->indexes.data(), diablo_buffer->indexes.size(), index_format::UINT32)
             };
             core.bind_buffer(buffer_type::VERTEX, m_objects["diablo"].vbo);
             core.set_buffer_element_size(sizeof(diablo_buffer->vertexes[0]));
+            core.set_buffer_bounds(diablo_buffer->bounds_min, diablo_buffer->bounds_max);
+            set_mesh_vertex_layout();
 
 
             
 
-            Texture texture("..\\..\\..\\rasterizer\\app\\assets\\head.tga");
-            const Texture::Content* texture_content = texture.GetContent();
+            // the color map is streamed page by page, the page file is a cache in the temp directory, 
+            // baked again whenever it is missing or head.tga has changed since
+            const char* colored_texture_path = "..\\..\\..\\rasterizer\\app\\assets\\head.tga";
+            const uint64_t colored_texture_fingerprint = _file_fingerprint(colored_texture_path);
 
-            size_t colored_texture = core.create_texture(texture_content->width, texture_content->height, texture_content->channel_count, texture_content->data.data());
+            const std::filesystem::path page_file_directory = std::filesystem::temp_directory_path() / "software-rendering";
+            std::filesystem::create_directories(page_file_directory);
+            const std::string colored_page_file_path = (page_file_directory / "head.pages").string();
+            
+            size_t colored_texture = core.create_virtual_texture(colored_page_file_path.c_str(), colored_texture_fingerprint);
+            if (colored_texture == 0) {
+                Texture texture(colored_texture_path);
+                const Texture::Content* texture_content = texture.GetContent();
+
+                if (!core.write_page_file(colored_page_file_path.c_str(), texture_content->width, texture_content->height, texture_content->channel_count, 
+                    texture_content->data.data(), colored_texture_fingerprint)) {
+                    throw std::runtime_error("failed to write " + colored_page_file_path);
+                }
+                Texture::Unload(colored_texture_path);
+                
+                colored_texture = core.create_virtual_texture(colored_page_file_path.c_str(), colored_texture_fingerprint);
+            }
             core.bind_texture(colored_texture);
             core.activate_texture(0);
 
-            texture.Load("..\\..\\..\\rasterizer\\app\\assets\\head_nm.tga");
-            texture_content = texture.GetContent();
+            Texture texture("..\\..\\..\\rasterizer\\app\\assets\\head_nm.tga");
+            const Texture::Content* texture_content = texture.GetContent();
 
-            size_t normal_texture = core.create_texture(texture_content->width, texture_content->height, texture_content->channel_count, texture_content->data.data());
+            // the normal map stays RGBA8: BC1 and BC3 quantize the endpoints to 565 and keep 4 colors per block, which is visible in the lighting
+            size_t normal_texture = core.create_texture(texture_content->width, texture_content->height, texture_content->channel_count, texture_content->data.data(), true);
             core.bind_texture(normal_texture);
             core.activate_texture(1);
         }
@@ -160,18 +217,32 @@ namespace rasterization {
 
         MouseState prev_mouse_state, curr_mouse_state;
         m_window->IsMousePressed(prev_mouse_state);
+
+        // a frame is recorded into one buffer while the previous one may still be executing the other
+        command_buffer frames[2];
+        size_t frame_index = 0;
+        size_t frame_fence = 0;
         
         while (m_window->IsOpen()) {
             m_window->PollEvent();
 
             const float dt = _LockFPS();
             std::cout << "FPS: " << std::to_string(1.0f / dt) << "\ttime: " << dt << "\tms\n";
+
+            command_buffer& frame = frames[frame_index];
+            frame.reset();
+
+            if (m_resized) {
+                frame.viewport(m_resized_width, m_resized_height);
+                m_resized = false;
+            }
+            frame.bind_shader(m_gouraud_shader);
   
         #pragma region input
             if (m_window->IsMousePressed(curr_mouse_state) && curr_mouse_state.pressed_button == MouseState::PressedButton::LEFT) {
                 m_transform.rotation = rotate_y(m_transform.rotation, (prev_mouse_state.x - curr_mouse_state.x) * dt);
                 m_transform.rotation = rotate_x(m_transform.rotation, -(prev_mouse_state.y - curr_mouse_state.y) * dt);
-                core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
             }
             prev_mouse_state = curr_mouse_state;
 
@@ -192,96 +263,110 @@ namespace rasterization {
             if (m_window->IsKeyPressed(Key::LALT)) {
                 if (m_window->IsKeyPressed(Key::RIGHT_ARROW)) {
                     m_view_matrix = rotate_y(m_view_matrix, -angle);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 } else if (m_window->IsKeyPressed(Key::LEFT_ARROW)) {
                     m_view_matrix = rotate_y(m_view_matrix, angle);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 }
 
                 if (m_window->IsKeyPressed(Key::UP_ARROW)) {
                     m_view_matrix = rotate_x(m_view_matrix, -angle);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 } else if (m_window->IsKeyPressed(Key::DOWN_ARROW)) {
                     m_view_matrix = rotate_x(m_view_matrix, angle);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 }
 
                 if (m_window->IsKeyPressed(Key::D)) {
                     m_view_matrix = translate(m_view_matrix, vec3f::LEFT() * distance);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 } else if (m_window->IsKeyPressed(Key::A)) {
                     m_view_matrix = translate(m_view_matrix, vec3f::RIGHT() * distance);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 }
 
                 if (m_window->IsKeyPressed(Key::W)) {
                     m_view_matrix = translate(m_view_matrix, vec3f::FORWARD() * distance);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 } else if (m_window->IsKeyPressed(Key::S)) {
                     m_view_matrix = translate(m_view_matrix, vec3f::BACKWARD() * distance);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 }
 
                 if (m_window->IsKeyPressed(Key::SPASE)) {
                     m_view_matrix = translate(m_view_matrix, vec3f::DOWN() * distance);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 } else if (m_window->IsKeyPressed(Key::LCTRL)) {
                     m_view_matrix = translate(m_view_matrix, vec3f::UP() * distance);
-                    core.uniform(m_view_matrix, "view");
+                    frame.uniform(m_view_matrix, "view");
                 }
             } else {
                 if (m_window->IsKeyPressed(Key::RIGHT_ARROW)) {
                     m_transform.rotation = rotate_y(m_transform.rotation, -angle);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 } else if (m_window->IsKeyPressed(Key::LEFT_ARROW)) {
                     m_transform.rotation = rotate_y(m_transform.rotation, angle);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 }
 
                 if (m_window->IsKeyPressed(Key::UP_ARROW)) {
                     m_transform.rotation = rotate_x(m_transform.rotation, -angle);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 } else if (m_window->IsKeyPressed(Key::DOWN_ARROW)) {
                     m_transform.rotation = rotate_x(m_transform.rotation, angle);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 }
 
                 if (m_window->IsKeyPressed(Key::D)) {
                     m_transform.translation = translate(m_transform.translation, vec3f::RIGHT() * distance);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 } else if (m_window->IsKeyPressed(Key::A)) {
                     m_transform.translation = translate(m_transform.translation, vec3f::LEFT() * distance);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 }
 
                 if (m_window->IsKeyPressed(Key::W)) {
                     m_transform.translation = translate(m_transform.translation, vec3f::UP() * distance);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 } else if (m_window->IsKeyPressed(Key::S)) {
                     m_transform.translation = translate(m_transform.translation, vec3f::DOWN() * distance);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 }
 
                 if (m_window->IsKeyPressed(Key::Z)) {
                     m_transform.translation = translate(m_transform.translation, vec3f::BACKWARD() * distance);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 } else if (m_window->IsKeyPressed(Key::X)) {
                     m_transform.translation = translate(m_transform.translation, vec3f::FORWARD() * distance);
-                    core.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
+                    frame.uniform(m_transform.scale * m_transform.rotation * m_transform.translation, "model");
                 }
             }
         #pragma endregion input
          
-            core.bind_shader(m_gouraud_shader);
-            core.uniform(perspective(math::to_radians(90.0f), (float)m_window->GetWidth() / m_window->GetHeight(), 1.0f, 100.0f), "projection");
+            frame.uniform(perspective(math::to_radians(90.0f), (float)m_window->GetWidth() / m_window->GetHeight(), 1.0f, 100.0f), "projection");
             const Object& object = m_objects["head"];
-            core.bind_buffer(buffer_type::VERTEX, object.vbo);
-            core.bind_buffer(buffer_type::INDEX, object.ibo);
-            core.render(model_render_mode);
+            frame.bind_buffer(buffer_type::VERTEX, object.vbo);
+            frame.bind_buffer(buffer_type::INDEX, object.ibo);
+            frame.render(model_render_mode);
+            frame.render_lights(m_camera_position);
+            frame.resolve_frame();
+            frame.clear_depth_buffer();
+
+            // the previous frame is staged once its fence is signaled, it is presented here while this one is drawn, 
+            // as SDL is to be called from the main thread only
+            const size_t previous_fence = frame_fence;
+            core.wait_fence(previous_fence);
+            
+            frame_fence = core.submit(frame);
+            frame_index = (frame_index + 1) % 2;
 
-            core.swap_buffers(); 
-            core.clear_depth_buffer();
+            if (previous_fence != 0) {
+                core.present_frame();
+            }
         }
+
+        core.finish();
+        core.present_frame();
     }
     
     void Application::SetFPSLock(size_t fps) const noexcept {
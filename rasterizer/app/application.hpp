@@ -42,6 +42,11 @@ namespace rasterization {
         size_t m_simple_shader = 0;
         size_t m_gouraud_shader = 0;
 
+        // the size the window was resized to, recorded into the next frame as the engines may be busy with the current one
+        bool m_resized = false;
+        uint32_t m_resized_width = 0;
+        uint32_t m_resized_height = 0;
+
         mutable std::chrono::steady_clock::time_point m_last_frame;
         mutable float m_fps_lock;
     };
@@ -3,6 +3,8 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tinyobjloader/tiny_obj_loader.h"
 
+#include <algorithm>
+
 #define LINE_STRING(line) #line
 #define MESH_LOADER_ERROR(file, function, line) "[MESH LOAD ERROR]\nfile: " file "\nfunction: " function "\nline: " LINE_STRING(line)
 
@@ -41,8 +43,10 @@ namespace rasterization {
         }
 
         Content buffer;
+        buffer.bounds_min = vec3f(MATH_INFINITY);
+        buffer.bounds_max = vec3f(-MATH_INFINITY);
         
-        std::unordered_map<Vertex, size_t> cached_vertex_indexes;
+        std::unordered_map<Vertex, uint32_t> cached_vertex_indexes;
         for (const auto& shape : shapes) {
             size_t iter_number = 0;
             for (const auto& index : shape.mesh.indices) {
@@ -70,8 +74,11 @@ namespace rasterization {
                 }
 
                 if (cached_vertex_indexes.count(v) == 0) {
-                    cached_vertex_indexes[v] = buffer.vertexes.size();
+                    cached_vertex_indexes[v] = static_cast<uint32_t>(buffer.vertexes.size());
                     buffer.vertexes.push_back(v);
+
+                    buffer.bounds_min = vec3f(std::min(buffer.bounds_min.x, v.position.x), std::min(buffer.bounds_min.y, v.position.y), std::min(buffer.bounds_min.z, v.position.z));
+                    buffer.bounds_max = vec3f(std::max(buffer.bounds_max.x, v.position.x), std::max(buffer.bounds_max.y, v.position.y), std::max(buffer.bounds_max.z, v.position.z));
                 }
 
                 buffer.indexes.push_back(cached_vertex_indexes[v]);
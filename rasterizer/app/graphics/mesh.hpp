@@ -6,6 +6,7 @@
 #include "math_3d/vec3.hpp"
 #include "math_3d/vec2.hpp"
 #include "math_3d/hash.hpp"
+#include "math_3d/const.hpp"
 
 namespace rasterization {
     class Mesh {
@@ -24,7 +25,11 @@ namespace rasterization {
     
         struct Content {
             std::vector<Vertex> vertexes;
-            std::vector<size_t> indexes;
+            std::vector<uint32_t> indexes;
+
+            // the bounding box of the vertex positions, see gl::_buffer_engine::set_buffer_bounds
+            math::vec3f bounds_min;
+            math::vec3f bounds_max;
         };
 
     public:
@@ -1,49 +1,136 @@
 #include "gouraud_shader.hpp"
 
 namespace rasterization {
-    struct VSInData {
-        math::vec3f position;
-        math::vec3f normal;
-        math::vec2f texcoord;
-    };
+    GouraudShader::GouraudShader() noexcept {
+        using namespace math;
+
+        uniform<mat4f>(MODEL, "model");
+        uniform<mat4f>(VIEW, "view");
+        uniform<mat4f>(PROJECTION, "projection");
+        uniform<vec3f>(LIGHT_POSITION, "light_position");
+        uniform<vec4f>(LIGHT_COLOR, "light_color");
+        uniform<float>(LIGHT_INTENSITY, "light_intensity");
+        uniform<vec3f>(CAMERA_POSITION, "camera_position");
+
+        varying<vec4f>(FRAG_POSITION);
+        varying<vec2f>(TEXCOORD);
+        varying<mat4f>(NORMAL_MATRIX, gl::interpolation::FLAT);
+        varying<vec4f>(TINT, gl::interpolation::FLAT);
+    }
 
     math::vec4f GouraudShader::vertex(const void *vertex, pd& _pd) const noexcept {
+        return GouraudShader::vertex(vertex, nullptr, _pd);
+    }
+
+    math::vec4f GouraudShader::vertex(const void *vertex, const void* instance, pd& _pd) const noexcept {
         using namespace math;
-        const VSInData* v = (const VSInData*)vertex;
+        const InstanceData* i = (const InstanceData*)instance;
         
-        const mat4f& model_matrix = get_uniform<mat4f>("model");
+        const mat4f& model_matrix = i != nullptr ? i->model : get_uniform<mat4f>(MODEL);
+        const vec4f position = vec4f(attribute<vec3f>(IN_POSITION, _pd), 1.0f);
+
+        out(position * model_matrix, FRAG_POSITION, _pd);
+        out(attribute<vec2f>(IN_TEXCOORD, _pd), TEXCOORD, _pd);
+        out(transpose(inverse(model_matrix)), NORMAL_MATRIX, _pd);
+        out(i != nullptr ? i->tint : color::WHITE, TINT, _pd);
 
-        out(vec4f(v->position, 1.0f) * model_matrix, "frag_position", _pd);
-        out(v->texcoord, "texcoord", _pd);
-        out(transpose(inverse(model_matrix)), "normal_matrix", _pd);
+        return position * model_matrix * get_uniform<mat4f>(VIEW) * get_uniform<mat4f>(PROJECTION);
+    }
 
-        return vec4f(v->position, 1.0f) * model_matrix * get_uniform<mat4f>("view") * get_uniform<mat4f>("projection");
+    bool GouraudShader::has_vertex_quad() const noexcept {
+        return true;
+    }
+
+    // vertex() without instances for 4 vertices, the normal matrix is the same for all of them
+    gl::quad_vec4f GouraudShader::vertex_quad(qvd& _qvd) const noexcept {
+        using namespace math;
+        using namespace gl;
+
+        const mat4f& model_matrix = get_uniform<mat4f>(MODEL);
+        const quad_vec4f world_position = quad_vec4f(attribute<quad_vec3f>(IN_POSITION, _qvd), 1.0f) * model_matrix;
+
+        out(world_position, FRAG_POSITION, _qvd);
+        out(attribute<quad_vec2f>(IN_TEXCOORD, _qvd), TEXCOORD, _qvd);
+        out(transpose(inverse(model_matrix)), NORMAL_MATRIX, _qvd);
+        out(color::WHITE, TINT, _qvd);
+
+        return world_position * get_uniform<mat4f>(VIEW) * get_uniform<mat4f>(PROJECTION);
     }
     
     math::color GouraudShader::pixel(const pd& _pd) const noexcept {
         using namespace math;
 
-        const vec3f& frag_position = in<vec4f>("frag_position", _pd).xyz;
-        const vec2f& texcoord = in<vec2f>("texcoord", _pd);
+        const vec3f& frag_position = in<vec4f>(FRAG_POSITION, _pd).xyz;
+        const vec2f& texcoord = in<vec2f>(TEXCOORD, _pd);
+        const vec2f texcoord_dx = ddx<vec2f>(TEXCOORD, _pd), texcoord_dy = ddy<vec2f>(TEXCOORD, _pd);
         
-        const vec3f normal = ((2.0f * texture(sampler_2D(1), texcoord) - vec4f(1.0f)) * in<mat4f>("normal_matrix", _pd)).xyz;
+        const vec3f normal = ((2.0f * texture_grad(sampler_2D(1), texcoord, texcoord_dx, texcoord_dy) - vec4f(1.0f)) * in<mat4f>(NORMAL_MATRIX, _pd)).xyz;
 
-        const color polygon_color = texture(sampler_2D(0), texcoord);
+        const color polygon_color = texture_grad(sampler_2D(0), texcoord, texcoord_dx, texcoord_dy) * in<vec4f>(TINT, _pd);
         const color ambient = 0.1f * polygon_color;
 
-        const vec3f light_dir = normalize(frag_position - get_uniform<vec3f>("light_position"));
+        const vec3f light_dir = normalize(frag_position - get_uniform<vec3f>(LIGHT_POSITION));
         const float diff = std::max(dot(-light_dir, normal), 0.0f);
-        const color diffuse = diff * get_uniform<vec4f>("light_color") * get_uniform<float>("light_intensity") * polygon_color;
+        const color diffuse = diff * get_uniform<vec4f>(LIGHT_COLOR) * get_uniform<float>(LIGHT_INTENSITY) * polygon_color;
 
         if (between(diff, 0.0f, 0.05f)) {
             return ambient + diffuse;
         }
 
-        const vec3f view_dir = normalize(frag_position - get_uniform<vec3f>("camera_position"));
+        const vec3f view_dir = normalize(frag_position - get_uniform<vec3f>(CAMERA_POSITION));
         const vec3f reflected = normalize(reflect(light_dir, normal));
         const float spec = std::max(std::powf(dot(reflected, -view_dir), 50.0f), 0.0f);
         const color specular = spec * polygon_color;
 
         return ambient + diffuse + specular;
     }
+
+    bool GouraudShader::has_pixel_quad() const noexcept {
+        return true;
+    }
+
+    // pixel() for the four pixels of a quad, the mip levels are chosen by the differences of the texcoords across it
+    gl::quad_color GouraudShader::pixel_quad(const qpd& _qpd) const noexcept {
+        using namespace math;
+        using namespace gl;
+
+        const quad_vec3f frag_position = in<quad_vec4f>(FRAG_POSITION, _qpd).xyz();
+        const quad_vec2f texcoord = in<quad_vec2f>(TEXCOORD, _qpd);
+
+        const quad_vec3f normal = ((2.0f * texture(sampler_2D(1), texcoord) - vec4f(1.0f)) * in<mat4f>(NORMAL_MATRIX, _qpd)).xyz();
+
+        const quad_color polygon_color = texture(sampler_2D(0), texcoord) * in<vec4f>(TINT, _qpd);
+        const quad_color ambient = 0.1f * polygon_color;
+
+        const quad_vec3f light_dir = normalize(frag_position - get_uniform<vec3f>(LIGHT_POSITION));
+        const quad_float diff = max(dot(-light_dir, normal), 0.0f);
+        const quad_color diffuse = diff * get_uniform<vec4f>(LIGHT_COLOR) * get_uniform<float>(LIGHT_INTENSITY) * polygon_color;
+
+        const quad_vec3f view_dir = normalize(frag_position - get_uniform<vec3f>(CAMERA_POSITION));
+        const quad_vec3f reflected = normalize(reflect(light_dir, normal));
+        const quad_float spec = max(pow(dot(reflected, -view_dir), 50.0f), 0.0f);
+        const quad_color specular = spec * polygon_color;
+
+        // the pixels which are barely lit take no specular
+        return select((diff >= 0.0f) & (diff <= 0.05f), ambient + diffuse, ambient + diffuse + specular);
+    }
+
+    bool GouraudShader::bounds_transform(math::mat4f& transform) const noexcept {
+        using namespace math;
+
+        transform = get_uniform<mat4f>(MODEL) * get_uniform<mat4f>(VIEW) * get_uniform<mat4f>(PROJECTION);
+        return true;
+    }
+
+    void GouraudShader::surface(const pd& _pd, gl::gbuffer_sample& sample) const noexcept {
+        using namespace math;
+
+        const vec2f& texcoord = in<vec2f>(TEXCOORD, _pd);
+        const vec2f texcoord_dx = ddx<vec2f>(TEXCOORD, _pd), texcoord_dy = ddy<vec2f>(TEXCOORD, _pd);
+
+        sample.albedo = texture_grad(sampler_2D(0), texcoord, texcoord_dx, texcoord_dy) * in<vec4f>(TINT, _pd);
+        sample.position = in<vec4f>(FRAG_POSITION, _pd).xyz;
+        sample.normal = normalize(((2.0f * texture_grad(sampler_2D(1), texcoord, texcoord_dx, texcoord_dy) - vec4f(1.0f)) * in<mat4f>(NORMAL_MATRIX, _pd)).xyz);
+        sample.shininess = 50.0f;
+    }
 }
\ No newline at end of file
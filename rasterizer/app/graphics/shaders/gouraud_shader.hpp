@@ -3,7 +3,29 @@
 
 namespace rasterization {
     struct GouraudShader : public gl::_shader {
+        // the per instance attributes for render_instanced
+        struct InstanceData {
+            math::mat4f model;
+            math::color tint;
+        };
+
+        // the vertex attributes, see Mesh::Vertex
+        enum AttributeLocation : size_t { IN_POSITION, IN_NORMAL, IN_TEXCOORD };
+
+        GouraudShader() noexcept;
+
         math::vec4f vertex(const void* vertex, pd& _pd) const noexcept override;
+        math::vec4f vertex(const void* vertex, const void* instance, pd& _pd) const noexcept override;
+        bool has_vertex_quad() const noexcept override;
+        gl::quad_vec4f vertex_quad(qvd& _qvd) const noexcept override;
         math::color pixel(const pd& _pd) const noexcept override;
+        bool has_pixel_quad() const noexcept override;
+        gl::quad_color pixel_quad(const qpd& _qpd) const noexcept override;
+        bool bounds_transform(math::mat4f& transform) const noexcept override;
+        void surface(const pd& _pd, gl::gbuffer_sample& sample) const noexcept override;
+
+    private:
+        enum UniformLocation : size_t { MODEL, VIEW, PROJECTION, LIGHT_POSITION, LIGHT_COLOR, LIGHT_INTENSITY, CAMERA_POSITION };
+        enum VaryingLocation : size_t { FRAG_POSITION, TEXCOORD, NORMAL_MATRIX, TINT = NORMAL_MATRIX + 4 };
     };
 }
\ No newline at end of file
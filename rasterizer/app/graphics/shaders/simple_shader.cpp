@@ -1,21 +1,31 @@
 #include "simple_shader.hpp"
 
 namespace rasterization {
-    struct VSInData {
-        math::vec3f position;
-        math::color color;
-    };
+    SimpleShader::SimpleShader() noexcept {
+        using namespace math;
+
+        uniform<mat4f>(MODEL, "model");
+        uniform<mat4f>(VIEW, "view");
+        uniform<mat4f>(PROJECTION, "projection");
+
+        varying<color>(COLOR);
+    }
 
     math::vec4f SimpleShader::vertex(const void *vertex, pd& _pd) const noexcept {
         using namespace math;
-        
-        const VSInData* v = (const VSInData*)vertex;
 
-        out(v->color, "color", _pd);
-        return vec4f(v->position, 1.0f) * get_uniform<mat4f>("model") * get_uniform<mat4f>("view") * get_uniform<mat4f>("projection");
+        out(attribute<color>(IN_COLOR, _pd), COLOR, _pd);
+        return vec4f(attribute<vec3f>(IN_POSITION, _pd), 1.0f) * get_uniform<mat4f>(MODEL) * get_uniform<mat4f>(VIEW) * get_uniform<mat4f>(PROJECTION);
     }
     
     math::color SimpleShader::pixel(const pd& _pd) const noexcept {
-        return in<math::color>("color", _pd);
+        return in<math::color>(COLOR, _pd);
+    }
+    
+    bool SimpleShader::bounds_transform(math::mat4f& transform) const noexcept {
+        using namespace math;
+
+        transform = get_uniform<mat4f>(MODEL) * get_uniform<mat4f>(VIEW) * get_uniform<mat4f>(PROJECTION);
+        return true;
     }
 }
\ No newline at end of file
@@ -3,7 +3,16 @@
 
 namespace rasterization {
     struct SimpleShader : public gl::_shader {
+        enum AttributeLocation : size_t { IN_POSITION, IN_COLOR };
+
+        SimpleShader() noexcept;
+
         math::vec4f vertex(const void* vertex, pd& _pd) const noexcept override;
         math::color pixel(const pd& _pd) const noexcept override;
+        bool bounds_transform(math::mat4f& transform) const noexcept override;
+
+    private:
+        enum UniformLocation : size_t { MODEL, VIEW, PROJECTION };
+        enum VaryingLocation : size_t { COLOR };
     };
 }
\ No newline at end of file
@@ -39,4 +39,8 @@ namespace rasterization {
     const Texture::Content *Texture::GetContent() const noexcept {
         return m_content;
     }
+
+    void Texture::Unload(const char *filename) noexcept {
+        already_loaded_textures.erase(filename);
+    }
 }
\ No newline at end of file
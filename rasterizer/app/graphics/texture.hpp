@@ -22,6 +22,9 @@ namespace rasterization {
 
         const Content* GetContent() const noexcept;
 
+        // frees the decoded image of 'filename', the content of the Textures that loaded it is no longer valid
+        static void Unload(const char* filename) noexcept;
+
     private:
         static std::unordered_map<std::string, Content> already_loaded_textures;
 
@@ -1,9 +1,11 @@
 #include "buffer_engine.hpp"
-#include "math_3d/util.hpp"
 
 #include "core/assert_macro.hpp"
 
-#define _ASSERT_BUFFER_ID_VALIDITY(container, id) ASSERT(container.find((id)) != container.cend(), "buffer engine error", "invalid buffer ID")
+#include <algorithm>
+#include <limits>
+
+#define _ASSERT_BUFFER_ID_VALIDITY(container, id) ASSERT(container.contains((id)), "buffer engine error", "invalid buffer ID")
 
 namespace gl {
     _buffer_engine &_buffer_engine::get() noexcept {
@@ -12,31 +14,36 @@ namespace gl {
     }
     
     size_t _buffer_engine::create_vertex_buffer(const void *buffer, size_t size) noexcept {
-        size_t id;
-        do {
-            id = math::random((size_t)0, SIZE_MAX - 1) + 1;
-        } while (m_vbos.find(id) != m_vbos.cend());
-
-        m_vbos[id] = vertex_buffer { std::vector<uint8_t>((uint8_t*)buffer, (uint8_t*)buffer + size), 0 };
-    
-        return id;
+        return m_vbos.insert(vertex_buffer { std::vector<uint8_t>((uint8_t*)buffer, (uint8_t*)buffer + size), 0 });
     }
 
-    size_t _buffer_engine::create_index_buffer(const size_t *buffer, size_t count) noexcept {
-        size_t id;
-        do {
-            id = math::random((size_t)0, SIZE_MAX - 1) + 1;
-        } while (m_ibos.find(id) != m_ibos.cend());
-
-        m_ibos[id] = index_buffer {
-            std::vector<size_t>(buffer, buffer + count)
-        };
+    template <typename IndexType>
+    static std::vector<size_t> _find_restarts(const IndexType* indices, size_t count) noexcept {
+        std::vector<size_t> restarts;
+        for (size_t i = 0; i < count; ++i) {
+            if (indices[i] == std::numeric_limits<IndexType>::max()) {
+                restarts.push_back(i);
+            }
+        }
+        return restarts;
+    }
 
-        return id;
+    size_t _buffer_engine::create_index_buffer(const void *buffer, size_t count, index_format format) noexcept {
+        const size_t size = count * (format == index_format::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+        return m_ibos.insert(index_buffer {
+            std::vector<uint8_t>((uint8_t*)buffer, (uint8_t*)buffer + size),
+            format == index_format::UINT16 ? _find_restarts((const uint16_t*)buffer, count) : _find_restarts((const uint32_t*)buffer, count),
+            count,
+            format
+        });
     }
 
     void _buffer_engine::delete_vertex_buffer(size_t id) noexcept {
         m_vbos.erase(id);
+
+        if (m_binded_instance_buffer == id) {
+            m_binded_instance_buffer = 0;
+        }
     }
 
     void _buffer_engine::delete_index_buffer(size_t id) noexcept {
@@ -55,6 +62,11 @@ namespace gl {
             m_binded_ibo = id;
             break;
 
+        case buffer_type::INSTANCE:
+            ASSERT(id == 0 || m_vbos.contains(id), "buffer engine error", "invalid buffer ID");
+            m_binded_instance_buffer = id;
+            break;
+
         default:
             ASSERT(false, "buffer engine error", "invalid buffer_type");
             break;
@@ -62,17 +74,56 @@ namespace gl {
     }
     
     void _buffer_engine::set_buffer_element_size(size_t size) noexcept {
+        set_buffer_element_size(buffer_type::VERTEX, size);
+    }
+
+    void _buffer_engine::set_buffer_element_size(buffer_type type, size_t size) noexcept {
+        ASSERT(type != buffer_type::INDEX, "buffer engine error", "index buffers have no element size");
+        
+        const buffer_id id = type == buffer_type::INSTANCE ? m_binded_instance_buffer : m_binded_vbo;
+        _ASSERT_BUFFER_ID_VALIDITY(m_vbos, id);
+        m_vbos.get(id).element_size = size;
+    }
+    
+    void _buffer_engine::set_vertex_attribute(size_t location, size_t component_count, attribute_type type, size_t offset) noexcept {
+        ASSERT(location < MAX_VERTEX_ATTRIBUTES, "buffer engine error", "vertex attribute location is out of range");
+        ASSERT(component_count >= 1 && component_count <= 4, "buffer engine error", "a vertex attribute has 1 to 4 components");
+        _ASSERT_BUFFER_ID_VALIDITY(m_vbos, m_binded_vbo);
+
+        std::vector<vertex_attribute>& attributes = m_vbos.get(m_binded_vbo).attributes;
+        attributes.erase(std::remove_if(attributes.begin(), attributes.end(), [location](const vertex_attribute& attribute) {
+            return attribute.location == location;
+        }), attributes.end());
+        
+        attributes.push_back({ location, component_count, type, offset });
+    }
+
+    void _buffer_engine::set_buffer_bounds(const math::vec3f& min, const math::vec3f& max) noexcept {
+        ASSERT(min.x <= max.x && min.y <= max.y && min.z <= max.z, "buffer engine error", "invalid buffer bounds");
         _ASSERT_BUFFER_ID_VALIDITY(m_vbos, m_binded_vbo);
-        m_vbos[m_binded_vbo].element_size = size;
+
+        vertex_buffer& vbo = m_vbos.get(m_binded_vbo);
+        vbo.has_bounds = true;
+        vbo.bounds_min = min;
+        vbo.bounds_max = max;
     }
     
     const _buffer_engine::vertex_buffer &_buffer_engine::_get_binded_vertex_buffer() const noexcept {
         _ASSERT_BUFFER_ID_VALIDITY(m_vbos, m_binded_vbo);
-        return m_vbos.at(m_binded_vbo);
+        return m_vbos.get(m_binded_vbo);
+    }
+    
+    const _buffer_engine::vertex_buffer *_buffer_engine::_get_binded_instance_buffer() const noexcept {
+        if (m_binded_instance_buffer == 0) {
+            return nullptr;
+        }
+
+        _ASSERT_BUFFER_ID_VALIDITY(m_vbos, m_binded_instance_buffer);
+        return &m_vbos.get(m_binded_instance_buffer);
     }
     
     const _buffer_engine::index_buffer &_buffer_engine::_get_binded_index_buffer() const noexcept {
         _ASSERT_BUFFER_ID_VALIDITY(m_ibos, m_binded_ibo);
-        return m_ibos.at(m_binded_ibo);
+        return m_ibos.get(m_binded_ibo);
     }
 }
\ No newline at end of file
@@ -1,10 +1,32 @@
 #pragma once
-#include <unordered_map>
+#include "math_3d/math.hpp"
+#include "core/slot_map.hpp"
+
 #include <vector>
 
 namespace gl {
+    /**
+     * INSTANCE binds a vertex buffer whose elements are read once per instance 
+     * by render_instanced, binding 0 unbinds it.
+    */
     enum class buffer_type : uint8_t { 
-        VERTEX, INDEX
+        VERTEX, INDEX, INSTANCE
+    };
+
+    /**
+     * The component type of a vertex attribute, the engine converts it to float when fetching vertices. 
+     * The normalized types map UNORM to [0, 1] and SNORM to [-1, 1].
+    */
+    enum class attribute_type : uint8_t {
+        FLOAT, HALF_FLOAT, UNORM8, SNORM8, UNORM16, SNORM16
+    };
+
+    /**
+     * The largest value of a format, 0xFFFF or 0xFFFFFFFF, is the primitive restart index: 
+     * LINE_STRIP and TRIANGLE_STRIP begin a new strip after it, other modes must not use it.
+    */
+    enum class index_format : uint8_t {
+        UINT16, UINT32
     };
 
     class _buffer_engine final {
@@ -15,7 +37,7 @@ namespace gl {
         static _buffer_engine& get() noexcept;
 
         size_t create_vertex_buffer(const void* buffer, size_t size) noexcept;
-        size_t create_index_buffer(const size_t* buffer, size_t count) noexcept;
+        size_t create_index_buffer(const void* buffer, size_t count, index_format format) noexcept;
         
         void delete_vertex_buffer(size_t id) noexcept;
         void delete_index_buffer(size_t id) noexcept;
@@ -23,29 +45,76 @@ namespace gl {
         void bind_buffer(buffer_type type, size_t id) noexcept;
 
         void set_buffer_element_size(size_t size) noexcept;
+        void set_buffer_element_size(buffer_type type, size_t size) noexcept;
+
+        /**
+         * Describes the attribute at 'location' of the bound vertex buffer: 'component_count' components of 'type', 
+         * 'offset' bytes into every element, the element size is the stride. Shaders read it with attribute(), the 
+         * components and locations missing from the buffer read as (0, 0, 0, 1).
+        */
+        void set_vertex_attribute(size_t location, size_t component_count, attribute_type type, size_t offset) noexcept;
+
+        /**
+         * The box the positions of the bound vertex buffer lie in, in the space vertex() reads them in. A draw of 
+         * a buffer with bounds is skipped whole when the box is out of sight, see _shader::bounds_transform.
+        */
+        void set_buffer_bounds(const math::vec3f& min, const math::vec3f& max) noexcept;
+
+        static constexpr size_t MAX_VERTEX_ATTRIBUTES = 16;
 
     private:   
         _buffer_engine() = default;
 
     public:
+        struct vertex_attribute {
+            size_t location;
+            size_t component_count;
+            attribute_type type;
+            size_t offset;
+        };
+
         struct vertex_buffer {
             std::vector<uint8_t> data;
             size_t element_size;
+            // empty unless set_vertex_attribute was called, the shaders read 'data' themselves then
+            std::vector<vertex_attribute> attributes;
+
+            bool has_bounds = false;
+            math::vec3f bounds_min, bounds_max;
         };
         const vertex_buffer& _get_binded_vertex_buffer() const noexcept;
+        const vertex_buffer* _get_binded_instance_buffer() const noexcept;
         
         struct index_buffer {
-            std::vector<size_t> data;
+            template <typename IndexType>
+            const IndexType* indices() const noexcept {
+                return reinterpret_cast<const IndexType*>(data.data());
+            }
+
+            size_t index(size_t position) const noexcept {
+                return format == index_format::UINT16 ? indices<uint16_t>()[position] : indices<uint32_t>()[position];
+            }
+
+            size_t restart_index() const noexcept {
+                return format == index_format::UINT16 ? UINT16_MAX : UINT32_MAX;
+            }
+
+            std::vector<uint8_t> data;
+            // the positions of the restart indices, ascending
+            std::vector<size_t> restarts;
+            size_t count;
+            index_format format;
         };
         const index_buffer& _get_binded_index_buffer() const noexcept;
 
         using buffer_id = size_t;
 
     private:
-        std::unordered_map<buffer_id, vertex_buffer> m_vbos;
-        std::unordered_map<buffer_id, index_buffer> m_ibos;
+        _slot_map<vertex_buffer> m_vbos;
+        _slot_map<index_buffer> m_ibos;
 
         buffer_id m_binded_vbo = 0;
         buffer_id m_binded_ibo = 0;
+        buffer_id m_binded_instance_buffer = 0;
     };
 }
\ No newline at end of file
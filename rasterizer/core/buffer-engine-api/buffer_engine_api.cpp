@@ -10,8 +10,8 @@ namespace gl {
         return m_buffer_engine.create_vertex_buffer(buffer, size);
     }
 
-    size_t _buffer_engine_api::create_index_buffer(const size_t *buffer, size_t count) const noexcept {
-        return m_buffer_engine.create_index_buffer(buffer, count);
+    size_t _buffer_engine_api::create_index_buffer(const void *buffer, size_t count, index_format format) const noexcept {
+        return m_buffer_engine.create_index_buffer(buffer, count, format);
     }
 
     void _buffer_engine_api::delete_vertex_buffer(size_t id) const noexcept {
@@ -29,4 +29,16 @@ namespace gl {
     void _buffer_engine_api::set_buffer_element_size(size_t size) const noexcept {
         m_buffer_engine.set_buffer_element_size(size);
     }
+
+    void _buffer_engine_api::set_buffer_element_size(buffer_type type, size_t size) const noexcept {
+        m_buffer_engine.set_buffer_element_size(type, size);
+    }
+
+    void _buffer_engine_api::set_vertex_attribute(size_t location, size_t component_count, attribute_type type, size_t offset) const noexcept {
+        m_buffer_engine.set_vertex_attribute(location, component_count, type, offset);
+    }
+
+    void _buffer_engine_api::set_buffer_bounds(const math::vec3f& min, const math::vec3f& max) const noexcept {
+        m_buffer_engine.set_buffer_bounds(min, max);
+    }
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace gl {
         _buffer_engine_api();
 
         size_t create_vertex_buffer(const void* buffer, size_t size) const noexcept;
-        size_t create_index_buffer(const size_t* buffer, size_t count) const noexcept;
+        size_t create_index_buffer(const void* buffer, size_t count, index_format format) const noexcept;
         
         void delete_vertex_buffer(size_t id) const noexcept;
         void delete_index_buffer(size_t id) const noexcept;
@@ -15,6 +15,10 @@ namespace gl {
         void bind_buffer(buffer_type type, size_t id) const noexcept;
 
         void set_buffer_element_size(size_t size) const noexcept;
+        void set_buffer_element_size(buffer_type type, size_t size) const noexcept;
+
+        void set_vertex_attribute(size_t location, size_t component_count, attribute_type type, size_t offset) const noexcept;
+        void set_buffer_bounds(const math::vec3f& min, const math::vec3f& max) const noexcept;
     
     private:
         _buffer_engine& m_buffer_engine;
@@ -0,0 +1,121 @@
+#include "command_buffer.hpp"
+#include "core/texture-engine-api/texture_engine.hpp"
+
+namespace gl {
+    static _render_engine& render_engine = _render_engine::get();
+    static _buffer_engine& buff_engine = _buffer_engine::get();
+    static _shader_engine& shader_engine = _shader_engine::get();
+    static _texture_engine& tex_engine = _texture_engine::get();
+
+    void command_buffer::reset() noexcept {
+        m_commands.clear();
+    }
+
+    bool command_buffer::empty() const noexcept {
+        return m_commands.empty();
+    }
+
+    void command_buffer::bind_buffer(buffer_type type, size_t id) noexcept {
+        m_commands.emplace_back([type, id]() { buff_engine.bind_buffer(type, id); });
+    }
+
+    void command_buffer::set_buffer_element_size(size_t size) noexcept {
+        m_commands.emplace_back([size]() { buff_engine.set_buffer_element_size(size); });
+    }
+
+    void command_buffer::set_buffer_element_size(buffer_type type, size_t size) noexcept {
+        m_commands.emplace_back([type, size]() { buff_engine.set_buffer_element_size(type, size); });
+    }
+
+    void command_buffer::set_vertex_attribute(size_t location, size_t component_count, attribute_type type, size_t offset) noexcept {
+        m_commands.emplace_back([location, component_count, type, offset]() { buff_engine.set_vertex_attribute(location, component_count, type, offset); });
+    }
+
+    void command_buffer::set_buffer_bounds(const math::vec3f& min, const math::vec3f& max) noexcept {
+        m_commands.emplace_back([min, max]() { buff_engine.set_buffer_bounds(min, max); });
+    }
+
+    void command_buffer::bind_shader(size_t id) noexcept {
+        m_commands.emplace_back([id]() { shader_engine.bind_shader(id); });
+    }
+
+    void command_buffer::bind_texture(size_t id) noexcept {
+        m_commands.emplace_back([id]() { tex_engine.bind_texture(id); });
+    }
+
+    void command_buffer::activate_texture(size_t slot) noexcept {
+        m_commands.emplace_back([slot]() { tex_engine.activate_texture(slot); });
+    }
+
+    void command_buffer::viewport(uint32_t width, uint32_t height) noexcept {
+        m_commands.emplace_back([width, height]() { render_engine.viewport(width, height); });
+    }
+
+    void command_buffer::set_clear_color(const math::color& color) noexcept {
+        m_commands.emplace_back([color]() { render_engine.set_clear_color(color); });
+    }
+
+    void command_buffer::set_shading_mode(shading_mode mode) noexcept {
+        m_commands.emplace_back([mode]() { render_engine.set_shading_mode(mode); });
+    }
+
+    void command_buffer::set_sample_count(uint32_t count) noexcept {
+        m_commands.emplace_back([count]() { render_engine.set_sample_count(count); });
+    }
+
+    void command_buffer::set_line_antialiasing(bool enabled) noexcept {
+        m_commands.emplace_back([enabled]() { render_engine.set_line_antialiasing(enabled); });
+    }
+
+    void command_buffer::set_cull_mode(cull_mode mode) noexcept {
+        m_commands.emplace_back([mode]() { render_engine.set_cull_mode(mode); });
+    }
+
+    void command_buffer::set_front_face(winding front_face) noexcept {
+        m_commands.emplace_back([front_face]() { render_engine.set_front_face(front_face); });
+    }
+
+    void command_buffer::set_point_lights(const point_light* lights, size_t count) noexcept {
+        m_commands.emplace_back([lights = std::vector<point_light>(lights, lights + count)]() { 
+            render_engine.set_point_lights(lights.data(), lights.size()); 
+        });
+    }
+
+    void command_buffer::set_ambient_light(const math::color& color) noexcept {
+        m_commands.emplace_back([color]() { render_engine.set_ambient_light(color); });
+    }
+
+    void command_buffer::render(render_mode mode) noexcept {
+        m_commands.emplace_back([mode]() { render_engine.render(mode); });
+    }
+
+    void command_buffer::render_instanced(render_mode mode, size_t instance_count) noexcept {
+        m_commands.emplace_back([mode, instance_count]() { render_engine.render_instanced(mode, instance_count); });
+    }
+
+    void command_buffer::render_lights(const math::vec3f& camera_position) noexcept {
+        m_commands.emplace_back([camera_position]() { render_engine.render_lights(camera_position); });
+    }
+
+    void command_buffer::resolve_frame() noexcept {
+        m_commands.emplace_back([]() { render_engine.resolve_frame(); });
+    }
+
+    void command_buffer::clear_depth_buffer() noexcept {
+        m_commands.emplace_back([]() { render_engine.clear_depth_buffer(); });
+    }
+
+    void command_buffer::clear_color_buffer() noexcept {
+        m_commands.emplace_back([]() { render_engine.clear_color_buffer(); });
+    }
+
+    void command_buffer::bind_framebuffer(size_t id) noexcept {
+        m_commands.emplace_back([id]() { render_engine.bind_framebuffer(id); });
+    }
+
+    void command_buffer::_execute() const noexcept {
+        for (const auto& command : m_commands) {
+            command();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include "core/render-engine-api/render_engine.hpp"
+#include "core/buffer-engine-api/buffer_engine.hpp"
+#include "core/shader-engine-api/shader_engine.hpp"
+
+#include <functional>
+#include <vector>
+#include <string>
+
+namespace gl {
+    /**
+     * Records gl_api calls to be executed later, in order, by gl_api::submit. Values are copied 
+     * when recorded, uniform tags are resolved against the shader bound at execution. Like a 
+     * GPU command buffer it may be submitted many times, but must not be changed or destroyed 
+     * before the fence of its last submission is signaled.
+    */
+    class command_buffer final {
+    public:
+        command_buffer() = default;
+
+        void reset() noexcept;
+        bool empty() const noexcept;
+
+        void bind_buffer(buffer_type type, size_t id) noexcept;
+        void set_buffer_element_size(size_t size) noexcept;
+        void set_buffer_element_size(buffer_type type, size_t size) noexcept;
+        void set_vertex_attribute(size_t location, size_t component_count, attribute_type type, size_t offset) noexcept;
+        void set_buffer_bounds(const math::vec3f& min, const math::vec3f& max) noexcept;
+
+        void bind_shader(size_t id) noexcept;
+
+        template<typename Uniform>
+        void uniform(const Uniform& uniform, const std::string& uniform_tag) noexcept {
+            m_commands.emplace_back([uniform, uniform_tag]() { _shader_engine::get().uniform(uniform, uniform_tag); });
+        }
+
+        template<typename Uniform>
+        void uniform(const Uniform& uniform, size_t location) noexcept {
+            m_commands.emplace_back([uniform, location]() { _shader_engine::get().uniform(uniform, location); });
+        }
+
+        void bind_texture(size_t id) noexcept;
+        void activate_texture(size_t slot = 0) noexcept;
+
+        void viewport(uint32_t width, uint32_t height) noexcept;
+        void set_clear_color(const math::color& color) noexcept;
+        void set_shading_mode(shading_mode mode) noexcept;
+        void set_sample_count(uint32_t count) noexcept;
+        void set_line_antialiasing(bool enabled) noexcept;
+        void set_cull_mode(cull_mode mode) noexcept;
+        void set_front_face(winding front_face) noexcept;
+        
+        void set_point_lights(const point_light* lights, size_t count) noexcept;
+        void set_ambient_light(const math::color& color) noexcept;
+
+        void render(render_mode mode) noexcept;
+        void render_instanced(render_mode mode, size_t instance_count) noexcept;
+        void render_lights(const math::vec3f& camera_position) noexcept;
+
+        // stages the frame only, the main thread presents it by gl_api::present_frame once the buffer is done
+        void resolve_frame() noexcept;
+        void clear_depth_buffer() noexcept;
+        void clear_color_buffer() noexcept;
+        void bind_framebuffer(size_t id) noexcept;
+
+    public:
+        void _execute() const noexcept;
+
+    private:
+        std::vector<std::function<void()>> m_commands;
+    };
+}
\ No newline at end of file
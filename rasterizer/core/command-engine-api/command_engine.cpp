@@ -0,0 +1,74 @@
+#include "command_engine.hpp"
+
+namespace gl {
+    _command_engine& _command_engine::get() noexcept {
+        static _command_engine engine;
+        return engine;
+    }
+
+    _command_engine::_command_engine() noexcept
+        : m_thread(&_command_engine::_run, this)
+    {
+    }
+
+    _command_engine::~_command_engine() {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+
+        m_submitted_cv.notify_one();
+        m_thread.join();
+    }
+
+    size_t _command_engine::submit(const command_buffer& buffer) noexcept {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        
+        m_submissions.emplace(&buffer, ++m_last_fence);
+        m_submitted_cv.notify_one();
+
+        return m_last_fence;
+    }
+
+    bool _command_engine::is_fence_signaled(size_t fence) const noexcept {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        return m_signaled_fence >= fence;
+    }
+
+    void _command_engine::wait_fence(size_t fence) const noexcept {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_signaled_cv.wait(lock, [this, fence]() { return m_signaled_fence >= fence; });
+    }
+
+    void _command_engine::finish() const noexcept {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_signaled_cv.wait(lock, [this]() { return m_signaled_fence == m_last_fence; });
+    }
+
+    void _command_engine::_run() noexcept {
+        while (true) {
+            std::pair<const command_buffer*, size_t> submission;
+            
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_submitted_cv.wait(lock, [this]() { return m_quit || !m_submissions.empty(); });
+
+                // pending submissions are still executed, the application may wait for their fences
+                if (m_submissions.empty()) {
+                    return;
+                }
+
+                submission = m_submissions.front();
+                m_submissions.pop();
+            }
+
+            submission.first->_execute();
+
+            {
+                std::scoped_lock<std::mutex> lock(m_mutex);
+                m_signaled_fence = submission.second;
+            }
+            m_signaled_cv.notify_all();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include "command_buffer.hpp"
+
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <queue>
+
+namespace gl {
+    /**
+     * Executes submitted command buffers in submission order on its own thread, so the application 
+     * can prepare the next frame and present the previous one while the current one is drawn. Every submission 
+     * gets a fence, fences are signaled in increasing order. While anything is in flight the engines 
+     * belong to the submission thread: wait for the fence before calling gl_api directly.
+    */
+    class _command_engine final {
+    public:
+        _command_engine(const _command_engine& engine) = delete;
+        _command_engine& operator=(const _command_engine& engine) = delete;
+
+        static _command_engine& get() noexcept;
+
+        ~_command_engine();
+
+        size_t submit(const command_buffer& buffer) noexcept;
+
+        bool is_fence_signaled(size_t fence) const noexcept;
+        void wait_fence(size_t fence) const noexcept;
+        void finish() const noexcept;
+
+    private:
+        _command_engine() noexcept;
+
+        void _run() noexcept;
+
+    private:
+        std::queue<std::pair<const command_buffer*, size_t>> m_submissions;
+        size_t m_last_fence = 0;
+        size_t m_signaled_fence = 0;
+        bool m_quit = false;
+
+        mutable std::mutex m_mutex;
+        mutable std::condition_variable m_submitted_cv;
+        mutable std::condition_variable m_signaled_cv;
+
+        std::thread m_thread;
+    };
+}
\ No newline at end of file
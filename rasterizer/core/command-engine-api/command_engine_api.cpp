@@ -0,0 +1,24 @@
+#include "command_engine_api.hpp"
+
+namespace gl {
+    _command_engine_api::_command_engine_api()
+        : m_command_engine(_command_engine::get())
+    {
+    }
+
+    size_t _command_engine_api::submit(const command_buffer& buffer) const noexcept {
+        return m_command_engine.submit(buffer);
+    }
+
+    bool _command_engine_api::is_fence_signaled(size_t fence) const noexcept {
+        return m_command_engine.is_fence_signaled(fence);
+    }
+
+    void _command_engine_api::wait_fence(size_t fence) const noexcept {
+        m_command_engine.wait_fence(fence);
+    }
+
+    void _command_engine_api::finish() const noexcept {
+        m_command_engine.finish();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include "command_engine.hpp"
+
+namespace gl {
+    class _command_engine_api {
+    public:
+        _command_engine_api();
+
+        size_t submit(const command_buffer& buffer) const noexcept;
+
+        bool is_fence_signaled(size_t fence) const noexcept;
+        void wait_fence(size_t fence) const noexcept;
+        void finish() const noexcept;
+
+    private:
+        _command_engine& m_command_engine;
+    };
+}
\ No newline at end of file
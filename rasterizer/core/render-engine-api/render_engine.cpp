@@ -3,276 +3,1731 @@
 
 #include "core/shader-engine-api/shader.hpp"
 #include "core/shader-engine-api/shader_engine.hpp"
+#include "core/texture-engine-api/texture_engine.hpp"
 
 #include "core/assert_macro.hpp"   
 
+#include <limits>
+#include <cstring>
+
+#define _ASSERT_FRAMEBUFFER_ID_VALIDITY(container, id) ASSERT(container.contains((id)), "render engine error", "invalid framebuffer ID")
+#define _ASSERT_ATTACHMENT_VALIDITY(framebuffer, texture, expected_format) ASSERT((texture) == 0 || (tex_engine._get_texture((texture)).levels[0].format == (expected_format) && \
+    tex_engine._get_texture((texture)).width == (framebuffer).width && tex_engine._get_texture((texture)).height == (framebuffer).height), \
+    "render engine error", "an attachment is to be a render texture of the framebuffer's size and format")
+
 namespace gl {
     static _buffer_engine& buff_engine = _buffer_engine::get();
     static _shader_engine& shader_engine = _shader_engine::get();
+    static _texture_engine& tex_engine = _texture_engine::get();
+
+    _render_engine::_render_engine() noexcept 
+    {
+    }
+
+    // a strip of n indices has n - 2 triangles or n - 1 lines, those taking a restart index among them are skipped
+    static size_t _instance_primitive_count(const _buffer_engine::index_buffer& ibo, render_mode mode) noexcept {
+        switch (mode) {
+        case render_mode::TRIANGLE_STRIP:
+            return ibo.count >= 3 ? ibo.count - 2 : 0;
+        case render_mode::LINE_STRIP:
+            return ibo.count >= 2 ? ibo.count - 1 : 0;
+        case render_mode::LINES:
+            return ibo.count / 2;
+        default:
+            return ibo.count / 3;
+        }
+    }
+
+    void _render_engine::render(render_mode mode) noexcept {
+        render_instanced(mode, 1);
+    }
+
+    void _render_engine::render_instanced(render_mode mode, size_t instance_count) noexcept {
+        using namespace math;
+
+    #pragma region input-assembler    
+        const _buffer_engine::index_buffer& ibo = buff_engine._get_binded_index_buffer();
+    #pragma endregion input-assembler
+
+    #pragma region resizing-buffers
+        const _shader& shader = *shader_engine._get_binded_shader_program().shader;
+        m_varying_layout = shader._get_varying_layout();
+
+        _update_render_target();
+        _update_clip_planes();
+    #pragma endregion resizing-buffers
+
+        if (_is_out_of_sight(shader)) {
+            return;
+        }
+
+        switch (mode) {
+        case render_mode::POINTS: {
+            // points are written straight into the storage, only the tiles they land in are materialized
+            _process_vertices(shader, instance_count);
+
+            pipeline_pack_type pack;
+            for (const pipeline_metadata& vertex : m_pipeline_data) {
+                if ((vertex.outcode & VIEW_VOLUME_OUTCODES) == 0) {
+                    const float* varyings = _varyings(vertex);
+                    std::copy(varyings, varyings + m_varying_layout.components, pack.data);
+                    
+                    _render_pixel(vertex.coord.xy, shader.pixel(pack));
+                }
+            }    
+            break;
+        }
+        
+        case render_mode::LINES:
+        case render_mode::LINE_STRIP:
+        case render_mode::TRIANGLES:
+        case render_mode::TRIANGLE_STRIP: {
+        #pragma region primitive-processing
+            const size_t primitive_count = _instance_primitive_count(ibo, mode) * instance_count;
+            
+            m_chunk_count = (primitive_count + PRIMITIVE_CHUNK_SIZE - 1) / PRIMITIVE_CHUNK_SIZE;
+            if (m_chunks.size() < m_chunk_count) {
+                m_chunks.resize(m_chunk_count);
+            }
+
+            if (m_shading_mode != shading_mode::FORWARD && m_visibility_buffer.size() != m_z_buffer.size()) {
+                m_visibility_buffer.assign(m_z_buffer.size(), visibility_sample());
+            }
+
+            if (m_shading_mode == shading_mode::GBUFFER && m_gbuffer.size() != m_z_buffer.size()) {
+                m_gbuffer.resize(m_z_buffer.size());
+                m_gbuffer_owner.resize(m_z_buffer.size());
+                m_gbuffer_mask.assign(m_tiles.size() * TILE_PIXEL_COUNT, 0);
+            }
+
+            _parallel_for(m_chunk_count, [&](size_t chunk_index) {
+                const size_t first_primitive = chunk_index * PRIMITIVE_CHUNK_SIZE;
+                const size_t last_primitive = std::min(first_primitive + PRIMITIVE_CHUNK_SIZE, primitive_count);
+                
+                if (ibo.format == index_format::UINT16) {
+                    _process_chunk<uint16_t>(shader, m_chunks[chunk_index], mode, first_primitive, last_primitive);
+                } else {
+                    _process_chunk<uint32_t>(shader, m_chunks[chunk_index], mode, first_primitive, last_primitive);
+                }
+            });
+        #pragma endregion primitive-processing
+
+            _rasterize_tiles(mode == render_mode::LINES || mode == render_mode::LINE_STRIP);
+            break;
+        }
+
+        default:
+            ASSERT(false, "runtime", "invalid Rendering Mode");
+            break;
+        }
+    }
+
+    void _render_engine::_shade_vertex(const _shader& shader, const void* vertex, const void* instance, pipeline_metadata& metadata, float* varyings, pipeline_pack_type& pack) const noexcept {
+        metadata.clip_coord = instance != nullptr ? shader.vertex(vertex, instance, pack) : shader.vertex(vertex, pack);
+        std::copy(pack.data, pack.data + m_varying_layout.components, varyings);
+
+        metadata.outcode = _compute_outcode(metadata.clip_coord);
+        metadata.coord = (metadata.clip_coord / metadata.clip_coord.w) * m_viewport.matrix;
+    }
+
+    void _render_engine::_shade_vertex_quad(const _shader& shader, size_t count, pipeline_metadata* const* metadata, float* const* varyings, vertex_quad_pack_type& pack) const noexcept {
+        const quad_vec4f clip_coords = shader.vertex_quad(pack);
+
+        // varyings come in whole slots, a slot of the 4 lanes is transposed at once
+        for (size_t i = 0; i < m_varying_layout.components; i += VARYING_SLOT_COMPONENTS) {
+            __m128 slots[4] = { pack.data[i], pack.data[i + 1], pack.data[i + 2], pack.data[i + 3] };
+            _MM_TRANSPOSE4_PS(slots[0], slots[1], slots[2], slots[3]);
+
+            for (size_t lane = 0; lane < count; ++lane) {
+                _mm_storeu_ps(varyings[lane] + i, slots[lane]);
+            }
+        }
+
+        for (size_t lane = 0; lane < count; ++lane) {
+            metadata[lane]->clip_coord = clip_coords[lane];
+            metadata[lane]->outcode = _compute_outcode(metadata[lane]->clip_coord);
+            metadata[lane]->coord = (metadata[lane]->clip_coord / metadata[lane]->clip_coord.w) * m_viewport.matrix;
+        }
+    }
+
+    #pragma region vertex-fetch
+    // the half floats in the low 16 bits of every lane
+    static __m128 _half_to_float(__m128i halves) noexcept {
+        const __m128i sign = _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x8000)), 16);
+        const __m128i magnitude = _mm_and_si128(halves, _mm_set1_epi32(0x7FFF));
+
+        // moved to the float's exponent and mantissa and scaled by 2^(127 - 15), which takes the denormals along
+        __m128 result = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)), _mm_castsi128_ps(_mm_set1_epi32(0x77800000)));
+        
+        // infinities and NaNs keep the largest exponent
+        const __m128 special = _mm_castsi128_ps(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7BFF)));
+        result = _mm_or_ps(result, _mm_and_ps(special, _mm_castsi128_ps(_mm_set1_epi32(0x7F800000))));
+
+        return _mm_or_ps(result, _mm_castsi128_ps(sign));
+    }
+
+    template <attribute_type TYPE>
+    static __m128 _convert_attribute(__m128i packed) noexcept {
+        if constexpr (TYPE == attribute_type::FLOAT) {
+            return _mm_castsi128_ps(packed);
+        } else if constexpr (TYPE == attribute_type::HALF_FLOAT) {
+            return _half_to_float(_mm_cvtepu16_epi32(packed));
+        } else if constexpr (TYPE == attribute_type::UNORM8) {
+            return _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(packed)), _mm_set1_ps(1.0f / 255.0f));
+        } else if constexpr (TYPE == attribute_type::SNORM8) {
+            return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepi8_epi32(packed)), _mm_set1_ps(1.0f / 127.0f)), _mm_set1_ps(-1.0f));
+        } else if constexpr (TYPE == attribute_type::UNORM16) {
+            return _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(packed)), _mm_set1_ps(1.0f / 65535.0f));
+        } else {
+            return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepi16_epi32(packed)), _mm_set1_ps(1.0f / 32767.0f)), _mm_set1_ps(-1.0f));
+        }
+    }
+
+    template <attribute_type TYPE>
+    static void _fetch_attribute(const _buffer_engine::vertex_buffer& vbo, const _buffer_engine::vertex_attribute& attribute, size_t first, size_t count, 
+        const size_t* indices, __m128* attributes) noexcept 
+    {
+        static constexpr size_t COMPONENT_SIZE = TYPE == attribute_type::FLOAT ? 4 : (TYPE == attribute_type::UNORM8 || TYPE == attribute_type::SNORM8 ? 1 : 2);
+        const size_t size = attribute.component_count * COMPONENT_SIZE;
+        ASSERT(attribute.offset + size <= vbo.element_size, "render engine error", "vertex attribute is out of the vertex");
+
+        // the components past the attribute's count are (0, 0, 0, 1)
+        const __m128 present = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int32_t>(attribute.component_count)), _mm_setr_epi32(0, 1, 2, 3)));
+        const __m128 defaults = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+
+        const uint8_t* end = vbo.data.data() + vbo.data.size();
+
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* src = vbo.data.data() + (indices != nullptr ? indices[i] : first + i) * vbo.element_size + attribute.offset;
+            
+            // the bytes past the attribute are blended away, but near the end of the buffer they are not there to load
+            __m128i packed = _mm_setzero_si128();
+            if (end - src >= static_cast<ptrdiff_t>(sizeof(__m128i))) {
+                packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            } else {
+                std::memcpy(&packed, src, size);
+            }
+            
+            attributes[i * _buffer_engine::MAX_VERTEX_ATTRIBUTES + attribute.location] = _mm_blendv_ps(defaults, _convert_attribute<TYPE>(packed), present);
+        }
+    }
+
+    // the locations the buffer's layout declares, a bit each
+    static uint32_t _declared_attributes(const _buffer_engine::vertex_buffer& vbo) noexcept {
+        uint32_t declared = 0;
+        for (const _buffer_engine::vertex_attribute& attribute : vbo.attributes) {
+            declared |= 1u << attribute.location;
+        }
+        return declared;
+    }
+
+    /**
+     * Converts the attributes of the vertices [first, first + count), or of the vertices 'indices' when given, to 'attributes', 
+     * MAX_VERTEX_ATTRIBUTES per vertex, the locations the layout does not declare are (0, 0, 0, 1). It goes attribute by 
+     * attribute, so the format is looked at once per run. False if the buffer has no attribute layout.
+    */
+    static bool _fetch_attributes(const _buffer_engine::vertex_buffer& vbo, size_t first, size_t count, __m128* attributes, const size_t* indices = nullptr) noexcept {
+        if (vbo.attributes.empty()) {
+            return false;
+        }
+
+        for (const _buffer_engine::vertex_attribute& attribute : vbo.attributes) {
+            switch (attribute.type) {
+            case attribute_type::FLOAT:      _fetch_attribute<attribute_type::FLOAT>(vbo, attribute, first, count, indices, attributes);      break;
+            case attribute_type::HALF_FLOAT: _fetch_attribute<attribute_type::HALF_FLOAT>(vbo, attribute, first, count, indices, attributes); break;
+            case attribute_type::UNORM8:     _fetch_attribute<attribute_type::UNORM8>(vbo, attribute, first, count, indices, attributes);     break;
+            case attribute_type::SNORM8:     _fetch_attribute<attribute_type::SNORM8>(vbo, attribute, first, count, indices, attributes);     break;
+            case attribute_type::UNORM16:    _fetch_attribute<attribute_type::UNORM16>(vbo, attribute, first, count, indices, attributes);    break;
+            case attribute_type::SNORM16:    _fetch_attribute<attribute_type::SNORM16>(vbo, attribute, first, count, indices, attributes);    break;
+            }
+        }
+
+        const uint32_t declared = _declared_attributes(vbo);
+        for (size_t location = 0; location < _buffer_engine::MAX_VERTEX_ATTRIBUTES; ++location) {
+            if ((declared & (1u << location)) == 0) {
+                for (size_t i = 0; i < count; ++i) {
+                    attributes[i * _buffer_engine::MAX_VERTEX_ATTRIBUTES + location] = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * The attributes of up to 4 fetched vertices to the SoA form of vertex_quad_pack_type. The lanes past 'count' 
+     * repeat the last vertex, so they are shaded like it and dropped.
+    */
+    static void _transpose_attributes(const _buffer_engine::vertex_buffer& vbo, const __m128* attributes, size_t count, __m128* soa) noexcept {
+        const uint32_t declared = _declared_attributes(vbo);
+        
+        for (size_t location = 0; location < _buffer_engine::MAX_VERTEX_ATTRIBUTES; ++location) {
+            __m128* components = soa + location * 4;
+            
+            if ((declared & (1u << location)) == 0) {
+                components[0] = components[1] = components[2] = _mm_setzero_ps();
+                components[3] = _mm_set1_ps(1.0f);
+                continue;
+            }
+
+            for (size_t lane = 0; lane < 4; ++lane) {
+                components[lane] = attributes[std::min(lane, count - 1) * _buffer_engine::MAX_VERTEX_ATTRIBUTES + location];
+            }
+            _MM_TRANSPOSE4_PS(components[0], components[1], components[2], components[3]);
+        }
+    }
+    #pragma endregion vertex-fetch
+
+    void _render_engine::_process_vertices(const _shader& shader, size_t instance_count) noexcept {
+        const _buffer_engine::vertex_buffer& vbo = buff_engine._get_binded_vertex_buffer();
+        const size_t vertex_count = vbo.data.size() / vbo.element_size;
+        const size_t total_count = vertex_count * instance_count;
+        
+        m_pipeline_data.resize(total_count);
+        m_varyings.resize(total_count * m_varying_layout.components);
+
+        const bool quad_shading = shader.has_vertex_quad() && !vbo.attributes.empty() && buff_engine._get_binded_instance_buffer() == nullptr;
+
+        // the vertices of instance k are [k * vertex_count, (k + 1) * vertex_count)
+        _parallel_for((total_count + VERTEX_BATCH_SIZE - 1) / VERTEX_BATCH_SIZE, [&](size_t batch) {
+            pipeline_pack_type pack;
+            vertex_quad_pack_type quad_pack;
+            __m128 attributes[ATTRIBUTE_BATCH_SIZE * _buffer_engine::MAX_VERTEX_ATTRIBUTES];
+            __m128 quad_attributes[_buffer_engine::MAX_VERTEX_ATTRIBUTES * 4];
+            quad_pack.attributes = quad_attributes;
+            
+            const size_t last = std::min((batch + 1) * VERTEX_BATCH_SIZE, total_count);
+            for (size_t first = batch * VERTEX_BATCH_SIZE; first < last; ) {
+                // a run stays within one instance, so its vertices are consecutive in the buffer
+                const size_t count = std::min({ ATTRIBUTE_BATCH_SIZE, last - first, vertex_count - first % vertex_count });
+                const bool fetched = _fetch_attributes(vbo, first % vertex_count, count, attributes);
+
+                if (quad_shading) {
+                    for (size_t i = first; i < first + count; i += 4) {
+                        const size_t quad_count = std::min<size_t>(4, first + count - i);
+                        _transpose_attributes(vbo, &attributes[(i - first) * _buffer_engine::MAX_VERTEX_ATTRIBUTES], quad_count, quad_attributes);
+                    
+                        pipeline_metadata* metadata[4];
+                        float* varyings[4];
+                        for (size_t lane = 0; lane < quad_count; ++lane) {
+                            metadata[lane] = &m_pipeline_data[i + lane];
+                            varyings[lane] = &m_varyings[(i + lane) * m_varying_layout.components];
+                        }
+                        _shade_vertex_quad(shader, quad_count, metadata, varyings, quad_pack);
+                    }
+                } else {
+                    for (size_t i = first; i < first + count; ++i) {
+                        pack.attributes = fetched ? &attributes[(i - first) * _buffer_engine::MAX_VERTEX_ATTRIBUTES] : nullptr;
+                        _shade_vertex(shader, &vbo.data[i % vertex_count * vbo.element_size], _instance_data(i / vertex_count), 
+                            m_pipeline_data[i], &m_varyings[i * m_varying_layout.components], pack);
+                    }
+                }
+                first += count;
+            }
+        });
+    }
+
+    const void* _render_engine::_instance_data(size_t instance) const noexcept {
+        const _buffer_engine::vertex_buffer* instances = buff_engine._get_binded_instance_buffer();
+        if (instances == nullptr) {
+            return nullptr;
+        }
+
+        ASSERT(instance < instances->data.size() / instances->element_size, "render engine error", "instance is out of the instance buffer");
+        return &instances->data[instance * instances->element_size];
+    }
+
+    template <typename IndexType>
+    void _render_engine::_process_chunk(const _shader& shader, primitive_chunk& chunk, render_mode mode, size_t first_primitive, size_t last_primitive) noexcept {
+        const _buffer_engine::vertex_buffer& vbo = buff_engine._get_binded_vertex_buffer();
+        const _buffer_engine::index_buffer& ibo = buff_engine._get_binded_index_buffer();
+        const IndexType* indices = ibo.indices<IndexType>();
+
+        const size_t vertex_count = vbo.data.size() / vbo.element_size;
+        const size_t instance_primitive_count = _instance_primitive_count(ibo, mode);
+        const bool strip = mode == render_mode::TRIANGLE_STRIP;
+        const bool line_strip = mode == render_mode::LINE_STRIP;
+        const size_t primitive_vertex_count = mode == render_mode::LINES || line_strip ? 2 : 3;
+        
+        chunk.vertices.clear();
+        chunk.varyings.clear();
+        chunk.triangles.clear();
+        chunk.lines.clear();
+        chunk.bins.clear();
+
+    #pragma region post-transform-cache
+        // direct-mapped: slot i remembers which vertex it holds, keyed by instance * vertex_count + index, 
+        // and where it was shaded to
+        size_t cache_tags[VERTEX_CACHE_SIZE];
+        size_t cache_vertices[VERTEX_CACHE_SIZE];
+        std::fill(std::begin(cache_tags), std::end(cache_tags), SIZE_MAX);
+
+        // the missed vertices are given their places in the chunk at once, but wait to be shaded together, 
+        // at the latest before the primitives using them are assembled
+        size_t pending_first = 0;
+        size_t pending_indices[PENDING_VERTEX_COUNT];
+        size_t pending_instances[PENDING_VERTEX_COUNT];
+        size_t pending_count = 0;
+
+        const auto shade_pending = [&]() {
+            _fetch_vertices(shader, chunk, pending_first, pending_indices, pending_instances, pending_count);
+            pending_count = 0;
+        };
+
+        size_t local[3];
+
+        // lines are batched too, so that the vertices they miss are shaded together
+        size_t batch[CULL_BATCH_SIZE][3];
+        size_t batch_size = 0;
+
+        const auto assemble_batch = [&]() {
+            shade_pending();
+            if (primitive_vertex_count == 2) {
+                for (size_t b = 0; b < batch_size; ++b) {
+                    _assemble_line(chunk, batch[b][0], batch[b][1]);
+                }
+            } else {
+                _assemble_triangles(chunk, batch, batch_size);
+            }
+            batch_size = 0;
+        };
+
+        size_t instance = first_primitive / instance_primitive_count;
+        size_t primitive = first_primitive % instance_primitive_count;
+
+        // the first triangle of the current strip, the winding flips with every next one. 
+        // A restart index at 'primitive + 2' at most ends the strip before the chunk's first triangle
+        size_t strip_start = 0;
+        if (strip) {
+            const auto restart = std::lower_bound(ibo.restarts.cbegin(), ibo.restarts.cend(), primitive + 2);
+            strip_start = restart != ibo.restarts.cbegin() ? *std::prev(restart) + 1 : 0;
+        }
+        
+        for (size_t p = first_primitive; p < last_primitive; ++p) {
+            const size_t i = strip || line_strip ? primitive : primitive_vertex_count * primitive;
+            
+            if (strip && indices[i + 2] == std::numeric_limits<IndexType>::max()) {
+                strip_start = i + 3;
+            }
+
+            // a line strip just skips the segments that touch a restart index
+            const bool restarted = line_strip && (indices[i] == std::numeric_limits<IndexType>::max() || indices[i + 1] == std::numeric_limits<IndexType>::max());
+
+            if (primitive >= strip_start && !restarted) {
+                for (size_t k = 0; k < primitive_vertex_count; ++k) {
+                    const size_t index = indices[i + k];
+                    const size_t key = instance * vertex_count + index;
+                    const size_t slot = key & (VERTEX_CACHE_SIZE - 1);
+                    
+                    if (cache_tags[slot] != key) {
+                        ASSERT(index < vertex_count, "render engine error", "vertex index is out of the vertex buffer");
+                        
+                        cache_tags[slot] = key;
+                        cache_vertices[slot] = chunk.vertices.size();
+                        
+                        chunk.vertices.emplace_back();
+                        chunk.varyings.resize(chunk.varyings.size() + m_varying_layout.components);
+
+                        if (pending_count == 0) {
+                            pending_first = cache_vertices[slot];
+                        }
+                        pending_indices[pending_count] = index;
+                        pending_instances[pending_count] = instance;
+                        
+                        if (++pending_count == PENDING_VERTEX_COUNT) {
+                            shade_pending();
+                        }
+                    }
+                    local[k] = cache_vertices[slot];
+                }
+
+                if (strip && ((primitive - strip_start) & 1) != 0) {
+                    std::swap(local[0], local[1]);
+                }
+                std::copy(local, local + primitive_vertex_count, batch[batch_size]);
+
+                if (++batch_size == CULL_BATCH_SIZE) {
+                    assemble_batch();
+                }
+            }
+
+            if (++primitive == instance_primitive_count) {
+                primitive = 0;
+                strip_start = 0;
+                ++instance;
+            }
+        }
+    #pragma endregion post-transform-cache
+
+        assemble_batch();
+        _sort_bins(chunk);
+    }
+
+    void _render_engine::_fetch_vertices(const _shader& shader, primitive_chunk& chunk, size_t first_local, const size_t* indices, const size_t* instances, size_t count) const noexcept {
+        if (count == 0) {
+            return;
+        }
+        
+        const _buffer_engine::vertex_buffer& vbo = buff_engine._get_binded_vertex_buffer();
+        const size_t components = m_varying_layout.components;
+
+        __m128 attributes[PENDING_VERTEX_COUNT * _buffer_engine::MAX_VERTEX_ATTRIBUTES];
+        const bool fetched = _fetch_attributes(vbo, 0, count, attributes, indices);
+
+        if (fetched && shader.has_vertex_quad() && buff_engine._get_binded_instance_buffer() == nullptr) {
+            static_assert(PENDING_VERTEX_COUNT == 4, "the pending vertices are shaded as one quad");
+
+            __m128 quad_attributes[_buffer_engine::MAX_VERTEX_ATTRIBUTES * 4];
+            _transpose_attributes(vbo, attributes, count, quad_attributes);
+
+            vertex_quad_pack_type quad_pack;
+            quad_pack.attributes = quad_attributes;
+            
+            pipeline_metadata* metadata[4];
+            float* varyings[4];
+            for (size_t lane = 0; lane < count; ++lane) {
+                metadata[lane] = &chunk.vertices[first_local + lane];
+                varyings[lane] = &chunk.varyings[(first_local + lane) * components];
+            }
+            _shade_vertex_quad(shader, count, metadata, varyings, quad_pack);
+            return;
+        }
+        
+        pipeline_pack_type pack;
+        for (size_t i = 0; i < count; ++i) {
+            pack.attributes = fetched ? &attributes[i * _buffer_engine::MAX_VERTEX_ATTRIBUTES] : nullptr;
+            _shade_vertex(shader, &vbo.data[indices[i] * vbo.element_size], _instance_data(instances[i]), 
+                chunk.vertices[first_local + i], &chunk.varyings[(first_local + i) * components], pack);
+        }
+    }
+
+    void _render_engine::_render_pixel(const math::vec2f& pixel, const math::color& color) noexcept {
+        if (pixel.x >= 0.0f && pixel.y >= 0.0f && pixel.x < m_render_target.width && pixel.y < m_render_target.height) {
+            const uint32_t x = static_cast<uint32_t>(pixel.x), y = static_cast<uint32_t>(pixel.y);
+            _materialize_tile(x / TILE_SIZE + y / TILE_SIZE * m_render_target.tiles_x);
+
+            const size_t pixel_index = _pixel_index(x, y);
+            const uint32_t packed_color = _pack_color(R_G_B_A(color));
+            
+            for (uint32_t s = 0; s < m_render_target.sample_count; ++s) {
+                m_color_buffer[pixel_index + s * TILE_PIXEL_COUNT] = packed_color;
+            }
+        }
+    }
+
+    // 'src' over 'dst' by 'coverage', per channel
+    static uint32_t _blend_color(uint32_t src, uint32_t dst, float coverage) noexcept {
+        const __m128 s = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int32_t>(src))));
+        const __m128 d = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int32_t>(dst))));
+        
+        const __m128i blended = _mm_cvtps_epi32(_mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(s, d), _mm_set1_ps(coverage))));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(blended, blended), blended)));
+    }
+
+    template <uint32_t SAMPLE_COUNT>
+    void _render_engine::_render_line(uint32_t chunk_index, uint32_t line_index, tile& tile) noexcept {
+        using namespace std;
+
+        const primitive_chunk& chunk = m_chunks[chunk_index];
+        const line& line = chunk.lines[line_index];
+
+        if (line.min_z > tile.max_z + HIERARCHICAL_Z_EPSILON) {
+            return;
+        }
+
+        const auto& shader = shader_engine._get_binded_shader_program().shader;
+
+        // the tile's pixels along the line's axes, the minor ones clamped to the viewport too
+        const int32_t minor_extent = min(line.is_x_major ? m_viewport.height : m_viewport.width, 
+            static_cast<int32_t>(line.is_x_major ? m_render_target.height : m_render_target.width));
+        const int32_t tile_min_major = static_cast<int32_t>(line.is_x_major ? tile.x0 : tile.y0);
+        const int32_t tile_max_major = static_cast<int32_t>(line.is_x_major ? tile.x1 : tile.y1) - 1;
+        const int32_t tile_min_minor = static_cast<int32_t>(line.is_x_major ? tile.y0 : tile.x0);
+        const int32_t tile_max_minor = min(static_cast<int32_t>(line.is_x_major ? tile.y1 : tile.x1), minor_extent) - 1;
+
+        const int32_t first = max(line.min_major, tile_min_major), last = min(line.max_major, tile_max_major);
+        if (first > last) {
+            return;
+        }
+
+        const size_t tile_index = tile.x0 / TILE_SIZE + tile.y0 / TILE_SIZE * m_render_target.tiles_x;
+        const size_t tile_offset = tile_index * TILE_PIXEL_COUNT * SAMPLE_COUNT;
+        float* z_tile = &m_z_buffer[tile_offset];
+
+        const size_t components = m_varying_layout.components;
+        const float* varyings0 = chunk.varyings.data() + line.v0 * components;
+        const float* varyings1 = chunk.varyings.data() + line.v1 * components;
+
+        pipeline_pack_type pack;
+        _copy_flat_varyings(chunk.varyings.data() + line.provoking * components, pack);
+
+        // DDA: everything steps by a constant per pixel along the major axis
+        float minor = line.minor_origin + line.minor_step * first;
+        float t = line.t_origin + line.t_step * first;
+
+        for (int32_t major = first; major <= last; ++major, minor += line.minor_step, t += line.t_step) {
+            // the pixels across the line and their share of its coverage
+            int32_t minors[2] = { static_cast<int32_t>(floor(minor)), 0 };
+            float coverages[2] = { 1.0f, 0.0f };
+            
+            if (m_line_antialiasing) {
+                const float center = minor - 0.5f;
+                minors[0] = static_cast<int32_t>(floor(center));
+                minors[1] = minors[0] + 1;
+                coverages[1] = center - floor(center);
+                coverages[0] = 1.0f - coverages[1];
+            }
+
+            const float z = line.z0 + line.dz * t;
+            
+            bool is_shaded = false;
+            uint32_t packed_color = 0;
+
+            for (size_t k = 0; k < 2; ++k) {
+                if (coverages[k] <= 0.0f || minors[k] < tile_min_minor || minors[k] > tile_max_minor) {
+                    continue;
+                }
+                
+                const int32_t x = line.is_x_major ? major : minors[k], y = line.is_x_major ? minors[k] : major;
+                const size_t local_index = (x - tile.x0) + (y - tile.y0) * TILE_SIZE;
+
+                uint32_t samples = 0;
+                for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                    samples |= z <= z_tile[local_index + s * TILE_PIXEL_COUNT] ? 1u << s : 0;
+                }
+
+                if (samples == 0) {
+                    continue;
+                }
+
+                // both pixels across the line take the color of the point on it
+                if (!is_shaded) {
+                    const float q = line.inv_w[0] + (line.inv_w[1] - line.inv_w[0]) * t;
+                    const __m128 w1 = _mm_set1_ps(t * line.inv_w[1] / q);
+
+                    for (size_t i = 0; i < m_varying_layout.smooth_components; i += VARYING_SLOT_COMPONENTS) {
+                        const __m128 v0 = _mm_loadu_ps(varyings0 + i);
+                        _mm_store_ps(pack.data + i, _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(varyings1 + i), v0), w1)));
+                    }
+
+                    packed_color = _pack_color(R_G_B_A(shader->pixel(pack)));
+                    is_shaded = true;
+                }
+
+                // the fainter pixel of an antialiased line is blended in without hiding what is behind it. 
+                // Depth only gets nearer, so the farthest depths of the tile and its blocks stay upper bounds
+                const bool writes_depth = coverages[k] >= 0.5f;
+                
+                for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                    if ((samples & (1u << s)) != 0) {
+                        uint32_t& color = m_color_buffer[tile_offset + local_index + s * TILE_PIXEL_COUNT];
+                        color = coverages[k] < 1.0f ? _blend_color(packed_color, color, coverages[k]) : packed_color;
+                        
+                        if (writes_depth) {
+                            z_tile[local_index + s * TILE_PIXEL_COUNT] = z;
+                        }
+                    }
+                }
+
+                if (tile.has_gbuffer_samples) {
+                    m_gbuffer_mask[tile_index * TILE_PIXEL_COUNT + local_index] &= ~samples;
+                }
+            }
+        }
+    }
+
+    template <uint32_t SAMPLE_COUNT>
+    void _render_engine::_render_polygon(uint32_t chunk_index, uint32_t triangle_index, tile& tile) noexcept {
+        using namespace math;
+        using namespace std;
+
+        const primitive_chunk& chunk = m_chunks[chunk_index];
+        const triangle& tri = chunk.triangles[triangle_index];
+
+        if (tri.min_z > tile.max_z + HIERARCHICAL_Z_EPSILON) {
+            return;
+        }
+
+        const auto& shader = shader_engine._get_binded_shader_program().shader;
+
+        const int32_t min_x = max(tri.min_x, static_cast<int32_t>(tile.x0)), max_x = min(tri.max_x, static_cast<int32_t>(tile.x1) - 1);
+        const int32_t min_y = max(tri.min_y, static_cast<int32_t>(tile.y0)), max_y = min(tri.max_y, static_cast<int32_t>(tile.y1) - 1);
+        if (min_x > max_x || min_y > max_y) {
+            return;
+        }
+
+    #pragma region interpolation-planes
+        // barycentric weights and depth are affine in screen space: set the planes up once relative to the tile origin,
+        // in double, so that the per pixel evaluation in float does not lose precision far from the screen origin
+        const double inv_area = 1.0 / static_cast<double>(tri.area);
+        
+        float w_origin[2], w_dx[2], w_dy[2];
+        for (size_t i = 0; i < 2; ++i) {
+            w_origin[i] = static_cast<float>((tri.a[i] * tile.x0 + tri.b[i] * tile.y0 + tri.c[i]) * inv_area);
+            w_dx[i] = static_cast<float>(tri.a[i] * inv_area);
+            w_dy[i] = static_cast<float>(tri.b[i] * inv_area);
+        }
+
+        const float z0 = chunk.vertices[tri.v0].coord.z, dz1 = chunk.vertices[tri.v1].coord.z - z0, dz2 = chunk.vertices[tri.v2].coord.z - z0;
+        const float z_origin = z0 + dz1 * w_origin[1] + dz2 * (1.0f - w_origin[0] - w_origin[1]);
+        const float z_dx = dz1 * w_dx[1] - dz2 * (w_dx[0] + w_dx[1]);
+        const float z_dy = dz1 * w_dy[1] - dz2 * (w_dy[0] + w_dy[1]);
+
+        // varyings are not affine in screen space, but w0 / w_0, w1 / w_1 and 1 / w are: the perspective correct 
+        // weights are the first two divided by the last one, a single reciprocal per pixel
+        const float q1 = tri.inv_w[0] - tri.inv_w[2], q2 = tri.inv_w[1] - tri.inv_w[2];
+        const float q_origin = tri.inv_w[2] + q1 * w_origin[0] + q2 * w_origin[1];
+        const float q_dx = q1 * w_dx[0] + q2 * w_dx[1];
+        const float q_dy = q1 * w_dy[0] + q2 * w_dy[1];
+    #pragma endregion interpolation-planes
+
+        // 2x2 quad lanes: (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1)
+        const __m128i lane_x = _mm_setr_epi32(0, 1, 0, 1), lane_y = _mm_setr_epi32(0, 0, 1, 1);
+        const __m128 lane_xf = _mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f), lane_yf = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+
+        const __m128 p0_origin = _mm_set1_ps(w_origin[0] * tri.inv_w[0]), p0_dx = _mm_set1_ps(w_dx[0] * tri.inv_w[0]), p0_dy = _mm_set1_ps(w_dy[0] * tri.inv_w[0]);
+        const __m128 p1_origin = _mm_set1_ps(w_origin[1] * tri.inv_w[1]), p1_dx = _mm_set1_ps(w_dx[1] * tri.inv_w[1]), p1_dy = _mm_set1_ps(w_dy[1] * tri.inv_w[1]);
+        const __m128 qs_origin = _mm_set1_ps(q_origin), qs_dx = _mm_set1_ps(q_dx), qs_dy = _mm_set1_ps(q_dy);
+        const __m128 zs_dx = _mm_set1_ps(z_dx), zs_dy = _mm_set1_ps(z_dy);
+
+        // depth is evaluated at the samples, everything else at the pixel center
+        __m128 zs_offset[SAMPLE_COUNT];
+        for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+            zs_offset[s] = SAMPLE_COUNT == 1 ? _mm_setzero_ps() : 
+                _mm_set1_ps((z_dx * MSAA_SAMPLE_OFFSETS[s][0] + z_dy * MSAA_SAMPLE_OFFSETS[s][1]) / SUBPIXEL_STEPS);
+        }
+        const int64_t sample_reach = SAMPLE_COUNT == 1 ? 0 : MSAA_SAMPLE_REACH;
+
+        const size_t tile_index = tile.x0 / TILE_SIZE + tile.y0 / TILE_SIZE * m_render_target.tiles_x;
+        const size_t tile_offset = tile_index * TILE_PIXEL_COUNT * SAMPLE_COUNT;
+        float* z_tile = &m_z_buffer[tile_offset];
+        float* block_max_z = &m_block_max_z[tile_index * TILE_BLOCK_COUNT];
+        bool tile_updated = false;
+
+        const size_t components = m_varying_layout.components;
+        const float* varyings0 = chunk.varyings.data() + tri.v0 * components;
+        const float* varyings1 = chunk.varyings.data() + tri.v1 * components;
+        const float* varyings2 = chunk.varyings.data() + tri.v2 * components;
+
+        pipeline_pack_type pack;
+        _copy_flat_varyings(chunk.varyings.data() + tri.provoking * components, pack);
+        pack.vertex_varyings[0] = varyings0;
+        pack.vertex_varyings[1] = varyings1;
+        pack.vertex_varyings[2] = varyings2;
+
+        const bool quad_shading = m_shading_mode == shading_mode::FORWARD && shader->has_pixel_quad();
+        
+        quad_pack_type quad_pack;
+        if (quad_shading) {
+            std::copy(pack.data + m_varying_layout.smooth_components, pack.data + components, quad_pack.data + m_varying_layout.smooth_components);
+        }
+
+        const int32_t block_min_x = min_x & ~static_cast<int32_t>(BLOCK_SIZE - 1), block_min_y = min_y & ~static_cast<int32_t>(BLOCK_SIZE - 1);
+        for (int32_t by = block_min_y; by <= max_y; by += BLOCK_SIZE) {
+            for (int32_t bx = block_min_x; bx <= max_x; bx += BLOCK_SIZE) {
+            #pragma region block-classification
+                // edges are affine, so their extremes over the block are reached at its corner pixels, 
+                // samples move them at most by the edge's change over MSAA_SAMPLE_REACH subpixels
+                bool rejected = false;
+                __m128i e_row[3];
+                __m128i e_step_x[3], e_step_y[3];
+                __m128i e_sample[SAMPLE_COUNT][3];
+                
+                for (size_t i = 0; i < 3; ++i) {
+                    const int64_t e = tri.a[i] * bx + tri.b[i] * by + tri.c[i];
+                    const int64_t ext_x = tri.a[i] * (BLOCK_SIZE - 1), ext_y = tri.b[i] * (BLOCK_SIZE - 1);
+                    const int64_t ext_sample = (std::abs(tri.a[i]) + std::abs(tri.b[i])) / SUBPIXEL_STEPS * sample_reach;
+                    
+                    if (e + max<int64_t>(ext_x, 0) + max<int64_t>(ext_y, 0) + ext_sample < 0) {
+                        rejected = true;
+                        break;
+                    }
+
+                    if (e + min<int64_t>(ext_x, 0) + min<int64_t>(ext_y, 0) - ext_sample >= 0) {
+                        // the whole block is on the inner side: the edge takes no part in the coverage mask
+                        e_row[i] = e_step_x[i] = e_step_y[i] = _mm_setzero_si128();
+                        
+                        for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                            e_sample[s][i] = _mm_setzero_si128();
+                        }
+                    } else {
+                        // the edge crosses the block, so its values inside are bounded by the corner ones and fit int32
+                        const __m128i a = _mm_set1_epi32(static_cast<int32_t>(tri.a[i]));
+                        const __m128i b = _mm_set1_epi32(static_cast<int32_t>(tri.b[i]));
+                        
+                        e_row[i] = _mm_add_epi32(_mm_set1_epi32(static_cast<int32_t>(e)), _mm_add_epi32(_mm_mullo_epi32(a, lane_x), _mm_mullo_epi32(b, lane_y)));
+                        e_step_x[i] = _mm_slli_epi32(a, 1);
+                        e_step_y[i] = _mm_slli_epi32(b, 1);
+
+                        // a and b are whole pixel steps, so the offsets in subpixels divide them exactly
+                        for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                            e_sample[s][i] = SAMPLE_COUNT == 1 ? _mm_setzero_si128() : _mm_set1_epi32(static_cast<int32_t>(
+                                (tri.a[i] * MSAA_SAMPLE_OFFSETS[s][0] + tri.b[i] * MSAA_SAMPLE_OFFSETS[s][1]) / SUBPIXEL_STEPS));
+                        }
+                    }
+                }
+
+                if (rejected) {
+                    continue;
+                }
+            #pragma endregion block-classification
+
+            #pragma region hierarchical-z-test
+                float& block_z = block_max_z[(bx - tile.x0) / BLOCK_SIZE + (by - tile.y0) / BLOCK_SIZE * TILE_BLOCKS];
+                
+                const float z_block = z_origin + z_dx * (bx - static_cast<int32_t>(tile.x0)) + z_dy * (by - static_cast<int32_t>(tile.y0));
+                float block_min_z = z_block + min(z_dx, 0.0f) * (BLOCK_SIZE - 1) + min(z_dy, 0.0f) * (BLOCK_SIZE - 1);
+                if constexpr (SAMPLE_COUNT > 1) {
+                    block_min_z -= (std::abs(z_dx) + std::abs(z_dy)) * MSAA_SAMPLE_REACH / SUBPIXEL_STEPS;
+                }
+
+                if (max(block_min_z, tri.min_z) > block_z + HIERARCHICAL_Z_EPSILON) {
+                    continue;
+                }
+                
+                bool block_updated = false;
+            #pragma endregion hierarchical-z-test
+
+                for (int32_t qy = by; qy < by + static_cast<int32_t>(BLOCK_SIZE); qy += 2) {
+                    __m128i e0 = e_row[0], e1 = e_row[1], e2 = e_row[2];
+                    
+                    if (qy + 1 >= min_y && qy <= max_y) {
+                        const __m128 dy = _mm_add_ps(_mm_set1_ps(static_cast<float>(qy - static_cast<int32_t>(tile.y0))), lane_yf);
+
+                        for (int32_t qx = bx; qx < bx + static_cast<int32_t>(BLOCK_SIZE); qx += 2) {
+                            if (qx + 1 >= min_x && qx <= max_x) {
+                                int32_t coverage[SAMPLE_COUNT];
+                                int32_t covered = 0;
+                                
+                                for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                                    const __m128i e = _mm_or_si128(_mm_add_epi32(e0, e_sample[s][0]), _mm_or_si128(_mm_add_epi32(e1, e_sample[s][1]), _mm_add_epi32(e2, e_sample[s][2])));
+                                    coverage[s] = ~_mm_movemask_ps(_mm_castsi128_ps(e)) & 0xF;
+                                    covered |= coverage[s];
+                                }
+                                
+                                if (covered != 0) {
+                                #pragma region early-depth-test
+                                    const __m128 dx = _mm_add_ps(_mm_set1_ps(static_cast<float>(qx - static_cast<int32_t>(tile.x0))), lane_xf);
+                                    const __m128 z = _mm_add_ps(_mm_set1_ps(z_origin), _mm_add_ps(_mm_mul_ps(zs_dx, dx), _mm_mul_ps(zs_dy, dy)));
+                                    
+                                    float* z_quad = z_tile + (qx - tile.x0) + (qy - tile.y0) * TILE_SIZE;
+                                    
+                                    alignas(16) float zs[SAMPLE_COUNT][4];
+                                    int32_t passed[SAMPLE_COUNT];
+                                    int32_t mask = 0;
+                                    
+                                    for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                                        const float* z_plane = z_quad + s * TILE_PIXEL_COUNT;
+                                        const __m128 z_stored = _mm_setr_ps(z_plane[0], z_plane[1], z_plane[TILE_SIZE], z_plane[TILE_SIZE + 1]);
+                                        const __m128 z_sample = SAMPLE_COUNT == 1 ? z : _mm_add_ps(z, zs_offset[s]);
+                                        
+                                        _mm_store_ps(zs[s], z_sample);
+                                        passed[s] = coverage[s] & _mm_movemask_ps(_mm_cmple_ps(z_sample, z_stored));
+                                        mask |= passed[s];
+                                    }
+                                #pragma endregion early-depth-test
+
+                                    if (mask != 0) {
+                                        alignas(16) float w0s[4], w1s[4];
+                                        
+                                        const __m128 q = _mm_add_ps(qs_origin, _mm_add_ps(_mm_mul_ps(qs_dx, dx), _mm_mul_ps(qs_dy, dy)));
+                                        const __m128 w = _mm_div_ps(_mm_set1_ps(1.0f), q);
+                                        
+                                        const __m128 quad_w0 = _mm_mul_ps(_mm_add_ps(p0_origin, _mm_add_ps(_mm_mul_ps(p0_dx, dx), _mm_mul_ps(p0_dy, dy))), w);
+                                        const __m128 quad_w1 = _mm_mul_ps(_mm_add_ps(p1_origin, _mm_add_ps(_mm_mul_ps(p1_dx, dx), _mm_mul_ps(p1_dy, dy))), w);
+                                        _mm_store_ps(w0s, quad_w0);
+                                        _mm_store_ps(w1s, quad_w1);
+
+                                        // a quad shader runs once for the whole quad, its uncovered pixels too, the result is transposed into a color per lane
+                                        __m128 quad_colors[4];
+                                        if (quad_shading) {
+                                            _interpolate_quad_varyings(varyings0, varyings1, varyings2, quad_w0, quad_w1, quad_pack);
+                                            
+                                            const quad_color colors = shader->pixel_quad(quad_pack);
+                                            quad_colors[0] = colors.x.lanes;
+                                            quad_colors[1] = colors.y.lanes;
+                                            quad_colors[2] = colors.z.lanes;
+                                            quad_colors[3] = colors.w.lanes;
+                                            _MM_TRANSPOSE4_PS(quad_colors[0], quad_colors[1], quad_colors[2], quad_colors[3]);
+                                        }
+
+                                        for (int32_t lane = 0; lane < 4; ++lane) {
+                                            const int32_t x = qx + (lane & 1), y = qy + (lane >> 1);
+                                            
+                                            // quads may hang over the triangle's bounds, which are clamped to the tile and the viewport: 
+                                            // a lane past them may be covered, but lies in the next tile or outside the viewport
+                                            if ((mask & (1 << lane)) == 0 || x > max_x || y > max_y) {
+                                                continue;
+                                            }
+
+                                            const size_t local_index = (x - tile.x0) + (y - tile.y0) * TILE_SIZE;
+                                            
+                                            // the samples of the pixel which are covered and passed the depth test
+                                            uint32_t samples = 0;
+                                            for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                                                if ((passed[s] & (1 << lane)) != 0) {
+                                                    z_tile[local_index + s * TILE_PIXEL_COUNT] = zs[s][lane];
+                                                    samples |= 1u << s;
+                                                }
+                                            }
+                                            block_updated = true;
+
+                                            if (m_shading_mode != shading_mode::FORWARD) {
+                                                for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                                                    if ((samples & (1u << s)) != 0) {
+                                                        m_visibility_buffer[tile_offset + local_index + s * TILE_PIXEL_COUNT] = { chunk_index, triangle_index, w0s[lane], w1s[lane] };
+                                                    }
+                                                }
+                                                continue;
+                                            }
+
+                                            color pixel_color;
+                                            if (quad_shading) {
+                                                pixel_color = color(quad_colors[lane]);
+                                            } else {
+                                                _interpolate_varyings(varyings0, varyings1, varyings2, w0s[lane], w1s[lane], 1.0f - w0s[lane] - w1s[lane], pack);
+                                                _compute_weight_derivatives(tri, w0s[lane], w1s[lane], pack);
+                                                pixel_color = shader->pixel(pack);
+                                            }
+                                            
+                                            const uint32_t packed_color = _pack_color(R_G_B_A(pixel_color));
+                                            
+                                            for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                                                if ((samples & (1u << s)) != 0) {
+                                                    m_color_buffer[tile_offset + local_index + s * TILE_PIXEL_COUNT] = packed_color;
+                                                }
+                                            }
+                                            
+                                            if (tile.has_gbuffer_samples) {
+                                                m_gbuffer_mask[tile_index * TILE_PIXEL_COUNT + local_index] &= ~samples;
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+
+                            e0 = _mm_add_epi32(e0, e_step_x[0]);
+                            e1 = _mm_add_epi32(e1, e_step_x[1]);
+                            e2 = _mm_add_epi32(e2, e_step_x[2]);
+                        }
+                    }
+
+                    e_row[0] = _mm_add_epi32(e_row[0], e_step_y[0]);
+                    e_row[1] = _mm_add_epi32(e_row[1], e_step_y[1]);
+                    e_row[2] = _mm_add_epi32(e_row[2], e_step_y[2]);
+                }
+
+                if (block_updated) {
+                    __m128 z_max = _mm_set1_ps(-MATH_INFINITY);
+                    
+                    for (uint32_t s = 0; s < SAMPLE_COUNT; ++s) {
+                        const float* z_row = z_tile + s * TILE_PIXEL_COUNT + (bx - tile.x0) + (by - tile.y0) * TILE_SIZE;
+                        
+                        for (uint32_t row = 0; row < BLOCK_SIZE; ++row, z_row += TILE_SIZE) {
+                            z_max = _mm_max_ps(z_max, _mm_max_ps(_mm_loadu_ps(z_row), _mm_loadu_ps(z_row + 4)));
+                        }
+                    }
+                    z_max = _mm_max_ps(z_max, _mm_shuffle_ps(z_max, z_max, _MM_SHUFFLE(1, 0, 3, 2)));
+                    z_max = _mm_max_ps(z_max, _mm_shuffle_ps(z_max, z_max, _MM_SHUFFLE(2, 3, 0, 1)));
+                    
+                    block_z = _mm_cvtss_f32(z_max);
+                    tile_updated = true;
+                }
+            }
+        }
+
+        if (tile_updated) {
+            tile.max_z = *std::max_element(block_max_z, block_max_z + TILE_BLOCK_COUNT);
+            tile.has_visible_samples |= m_shading_mode != shading_mode::FORWARD;
+        }
+    }
+
+    void _render_engine::_compute_weight_derivatives(const triangle& tri, float w0, float w1, pipeline_pack_type& pack) const noexcept {
+        // with the screen space weights l[i] and q = sum(l[i] * inv_w[i]), the perspective correct ones are 
+        // w[i] = l[i] * inv_w[i] / q, so dw[i] = (dl[i] * inv_w[i] - w[i] * dq) / q, and 1 / q = sum(w[i] / inv_w[i])
+        const float w2 = 1.0f - w0 - w1;
+        const float clip_w = w0 / tri.inv_w[0] + w1 / tri.inv_w[1] + w2 / tri.inv_w[2];
+        
+        const float q_dx = tri.w_dx[0] * tri.inv_w[0] + tri.w_dx[1] * tri.inv_w[1] + tri.w_dx[2] * tri.inv_w[2];
+        const float q_dy = tri.w_dy[0] * tri.inv_w[0] + tri.w_dy[1] * tri.inv_w[1] + tri.w_dy[2] * tri.inv_w[2];
+
+        pack.dw_dx[0] = (tri.w_dx[0] * tri.inv_w[0] - w0 * q_dx) * clip_w;
+        pack.dw_dx[1] = (tri.w_dx[1] * tri.inv_w[1] - w1 * q_dx) * clip_w;
+        pack.dw_dy[0] = (tri.w_dy[0] * tri.inv_w[0] - w0 * q_dy) * clip_w;
+        pack.dw_dy[1] = (tri.w_dy[1] * tri.inv_w[1] - w1 * q_dy) * clip_w;
+    }
+
+    void _render_engine::_shade_visible_samples(size_t tile_index) noexcept {
+        tile& tile = m_tiles[tile_index];
+        if (!tile.has_visible_samples) {
+            return;
+        }
+
+        const auto& shader = shader_engine._get_binded_shader_program().shader;
+        const size_t components = m_varying_layout.components;
+        const uint32_t sample_count = m_render_target.sample_count;
+        
+        const size_t tile_offset = tile_index * TILE_PIXEL_COUNT;
+        visibility_sample* samples = &m_visibility_buffer[tile_offset * sample_count];
+        
+        pipeline_pack_type pack;
+        for (size_t i = 0; i < TILE_PIXEL_COUNT; ++i) {
+            for (uint32_t s = 0; s < sample_count; ++s) {
+                const visibility_sample sample = samples[i + s * TILE_PIXEL_COUNT];
+                if (sample.chunk == INVALID_CHUNK) {
+                    continue;
+                }
+
+                // the pixel is shaded once per triangle visible at its samples
+                uint32_t mask = 0;
+                for (uint32_t k = s; k < sample_count; ++k) {
+                    visibility_sample& other = samples[i + k * TILE_PIXEL_COUNT];
+                    
+                    if (other.chunk == sample.chunk && other.triangle == sample.triangle) {
+                        mask |= 1u << k;
+                        // the chunks are rebuilt by the next draw, so the samples must not outlive this one
+                        other.chunk = INVALID_CHUNK;
+                    }
+                }
+
+                const primitive_chunk& chunk = m_chunks[sample.chunk];
+                const triangle& tri = chunk.triangles[sample.triangle];
+                
+                pack.vertex_varyings[0] = chunk.varyings.data() + tri.v0 * components;
+                pack.vertex_varyings[1] = chunk.varyings.data() + tri.v1 * components;
+                pack.vertex_varyings[2] = chunk.varyings.data() + tri.v2 * components;
+                
+                _copy_flat_varyings(chunk.varyings.data() + tri.provoking * components, pack);
+                _interpolate_varyings(pack.vertex_varyings[0], pack.vertex_varyings[1], pack.vertex_varyings[2], sample.w0, sample.w1, 1.0f - sample.w0 - sample.w1, pack);
+                _compute_weight_derivatives(tri, sample.w0, sample.w1, pack);
+                
+                if (m_shading_mode == shading_mode::GBUFFER) {
+                    gbuffer_sample* surfaces = &m_gbuffer[tile_offset * sample_count + i];
+                    uint8_t* owners = &m_gbuffer_owner[tile_offset * sample_count + i];
+                    const uint32_t waiting = m_gbuffer_mask[tile_offset + i];
+
+                    // the waiting samples of another surface whose plane is taken by the triangle move it 
+                    // to the plane of the first of them, nothing else refers to that one
+                    for (uint32_t k = 0; k < sample_count; ++k) {
+                        const uint32_t owner = owners[k * TILE_PIXEL_COUNT];
+                        
+                        if ((mask & (1u << k)) == 0 && (waiting & (1u << k)) != 0 && (mask & (1u << owner)) != 0) {
+                            surfaces[k * TILE_PIXEL_COUNT] = surfaces[owner * TILE_PIXEL_COUNT];
+                            
+                            for (uint32_t j = k; j < sample_count; ++j) {
+                                if ((mask & (1u << j)) == 0 && (waiting & (1u << j)) != 0 && owners[j * TILE_PIXEL_COUNT] == owner) {
+                                    owners[j * TILE_PIXEL_COUNT] = static_cast<uint8_t>(k);
+                                }
+                            }
+                        }
+                    }
+
+                    shader->surface(pack, surfaces[s * TILE_PIXEL_COUNT]);
+                    for (uint32_t k = s; k < sample_count; ++k) {
+                        if ((mask & (1u << k)) != 0) {
+                            owners[k * TILE_PIXEL_COUNT] = static_cast<uint8_t>(s);
+                        }
+                    }
+                    m_gbuffer_mask[tile_offset + i] |= mask;
+                } else {
+                    const math::color pixel_color = shader->pixel(pack);
+                    const uint32_t packed_color = _pack_color(R_G_B_A(pixel_color));
+                    
+                    for (uint32_t k = s; k < sample_count; ++k) {
+                        if ((mask & (1u << k)) != 0) {
+                            m_color_buffer[tile_offset * sample_count + i + k * TILE_PIXEL_COUNT] = packed_color;
+                        }
+                    }
+
+                    if (tile.has_gbuffer_samples) {
+                        m_gbuffer_mask[tile_offset + i] &= ~mask;
+                    }
+                }
+            }
+        }
+
+        tile.has_visible_samples = false;
+        tile.has_gbuffer_samples |= m_shading_mode == shading_mode::GBUFFER;
+    }
+
+    void _render_engine::_light_tile(size_t tile_index, const math::vec3f& camera_position) noexcept {
+        using namespace math;
+
+        tile& tile = m_tiles[tile_index];
+        if (!tile.has_gbuffer_samples) {
+            return;
+        }
+        _materialize_tile(tile_index);
+
+        const uint32_t sample_count = m_render_target.sample_count;
+        const size_t tile_offset = tile_index * TILE_PIXEL_COUNT;
+        const gbuffer_sample* samples = &m_gbuffer[tile_offset * sample_count];
+        const uint8_t* owners = &m_gbuffer_owner[tile_offset * sample_count];
+        uint8_t* mask = &m_gbuffer_mask[tile_offset];
+
+    #pragma region light-culling
+        // the world space bounds of what the tile actually shows are tighter than its frustum: 
+        // they follow the depth range of the tile and skip the empty samples
+        vec3f bounds_min(MATH_INFINITY), bounds_max(-MATH_INFINITY);
+        for (size_t i = 0; i < TILE_PIXEL_COUNT; ++i) {
+            for (uint32_t s = 0; s < sample_count; ++s) {
+                if ((mask[i] & (1u << s)) != 0) {
+                    const vec3f& position = samples[i + owners[i + s * TILE_PIXEL_COUNT] * TILE_PIXEL_COUNT].position;
+                    bounds_min = vec3f(std::min(bounds_min.x, position.x), std::min(bounds_min.y, position.y), std::min(bounds_min.z, position.z));
+                    bounds_max = vec3f(std::max(bounds_max.x, position.x), std::max(bounds_max.y, position.y), std::max(bounds_max.z, position.z));
+                }
+            }
+        }
+
+        // the tiles of a worker reuse its list, it is never longer than m_point_lights
+        static thread_local std::vector<uint32_t> lights;
+        lights.clear();
+        
+        for (uint32_t l = 0; l < m_point_lights.size(); ++l) {
+            const point_light& light = m_point_lights[l];
+            
+            const vec3f closest(clamp(light.position.x, bounds_min.x, bounds_max.x), clamp(light.position.y, bounds_min.y, bounds_max.y), clamp(light.position.z, bounds_min.z, bounds_max.z));
+            const vec3f offset = light.position - closest;
+            
+            if (dot(offset, offset) < light.radius * light.radius) {
+                lights.push_back(l);
+            }
+        }
+    #pragma endregion light-culling
+
+        uint32_t* color_tile = &m_color_buffer[tile_offset * sample_count];
+
+        for (size_t i = 0; i < TILE_PIXEL_COUNT; ++i) {
+            uint32_t pending = mask[i];
+            mask[i] = 0;
+            
+            while (pending != 0) {
+                uint32_t first = 0;
+                while ((pending & (1u << first)) == 0) {
+                    ++first;
+                }
+                const uint32_t owner = owners[i + first * TILE_PIXEL_COUNT];
+                const gbuffer_sample& sample = samples[i + owner * TILE_PIXEL_COUNT];
+
+                // the samples showing the surface are lit once
+                uint32_t pixel_mask = 1u << first;
+                for (uint32_t s = first + 1; s < sample_count; ++s) {
+                    if ((pending & (1u << s)) != 0 && owners[i + s * TILE_PIXEL_COUNT] == owner) {
+                        pixel_mask |= 1u << s;
+                    }
+                }
+                pending &= ~pixel_mask;
 
-    _render_engine::_render_engine() noexcept 
-    {
+                color result = sample.albedo;
+
+                if (dot(sample.normal, sample.normal) != 0.0f) {
+                    const vec3f view_dir = normalize(camera_position - sample.position);
+                    result = m_ambient_light * sample.albedo;
+
+                    for (uint32_t l : lights) {
+                        const point_light& light = m_point_lights[l];
+                    
+                        const vec3f to_light = light.position - sample.position;
+                        const float distance_sq = dot(to_light, to_light);
+                        const float radius_sq = light.radius * light.radius;
+                        if (distance_sq >= radius_sq) {
+                            continue;
+                        }
+
+                        const vec3f light_dir = to_light / std::sqrt(distance_sq);
+                        const float diff = dot(light_dir, sample.normal);
+                        if (diff <= 0.0f) {
+                            continue;
+                        }
+
+                        float spec = 0.0f;
+                        if (sample.shininess > 0.0f) {
+                            spec = std::pow(std::max(dot(reflect(-light_dir, sample.normal), view_dir), 0.0f), sample.shininess);
+                        }
+
+                        const float falloff = 1.0f - distance_sq / radius_sq;
+                        result += (falloff * falloff * light.intensity * (diff + spec)) * light.color * sample.albedo;
+                    }
+                }
+
+                // the lighting is per surface, the samples showing it all take it
+                const uint32_t packed_color = _pack_color(R_G_B_A(result));
+                for (uint32_t s = 0; s < sample_count; ++s) {
+                    if ((pixel_mask & (1u << s)) != 0) {
+                        color_tile[i + s * TILE_PIXEL_COUNT] = packed_color;
+                    }
+                }
+            }
+        }
+
+        tile.has_gbuffer_samples = false;
     }
 
-    void _render_engine::render(render_mode mode) noexcept {
+    void _render_engine::_update_clip_planes() noexcept {
+        const float guard_band_x = 1.0f + 2.0f * GUARD_BAND_SIZE / m_viewport.width;
+        const float guard_band_y = 1.0f + 2.0f * GUARD_BAND_SIZE / m_viewport.height;
+
+        m_clip_planes[0] = math::vec4f(0.0f, 0.0f, 1.0f, 1.0f);
+        m_clip_planes[1] = math::vec4f(0.0f, 0.0f, -1.0f, 1.0f);
+        m_clip_planes[2] = math::vec4f(1.0f, 0.0f, 0.0f, guard_band_x);
+        m_clip_planes[3] = math::vec4f(-1.0f, 0.0f, 0.0f, guard_band_x);
+        m_clip_planes[4] = math::vec4f(0.0f, 1.0f, 0.0f, guard_band_y);
+        m_clip_planes[5] = math::vec4f(0.0f, -1.0f, 0.0f, guard_band_y);
+    }
+
+    uint16_t _render_engine::_compute_outcode(const math::vec4f& clip_coord) const noexcept {
+        uint16_t outcode = 0;
+        
+        outcode |= clip_coord.x < -clip_coord.w ? OUTSIDE_LEFT : 0;
+        outcode |= clip_coord.x > clip_coord.w ? OUTSIDE_RIGHT : 0;
+        outcode |= clip_coord.y < -clip_coord.w ? OUTSIDE_BOTTOM : 0;
+        outcode |= clip_coord.y > clip_coord.w ? OUTSIDE_TOP : 0;
+
+        for (size_t i = 0; i < CLIP_PLANE_COUNT; ++i) {
+            outcode |= dot(m_clip_planes[i], clip_coord) < 0.0f ? (OUTSIDE_NEAR << i) : 0;
+        }
+
+        return outcode;
+    }
+
+    bool _render_engine::_is_out_of_sight(const _shader& shader) const noexcept {
         using namespace math;
 
-    #pragma region input-assembler    
         const _buffer_engine::vertex_buffer& vbo = buff_engine._get_binded_vertex_buffer();
-        const _buffer_engine::index_buffer& ibo = buff_engine._get_binded_index_buffer();
-    #pragma endregion input-assembler
+        
+        // instances are placed by the instance buffer, which no single matrix accounts for
+        mat4f transform;
+        if (!vbo.has_bounds || buff_engine._get_binded_instance_buffer() != nullptr || !shader.bounds_transform(transform)) {
+            return false;
+        }
 
-    #pragma region resizing-buffers
-        const size_t vertex_count = vbo.data.size() / vbo.element_size;
+        // the box is out of sight when all its corners are on the outer side of one plane
+        uint16_t outcode = VIEW_VOLUME_OUTCODES;
+        for (size_t corner = 0; corner < 8 && outcode != 0; ++corner) {
+            const vec4f position(
+                (corner & 1) ? vbo.bounds_max.x : vbo.bounds_min.x,
+                (corner & 2) ? vbo.bounds_max.y : vbo.bounds_min.y,
+                (corner & 4) ? vbo.bounds_max.z : vbo.bounds_min.z,
+                1.0f
+            );
+            outcode &= _compute_outcode(position * transform);
+        }
 
-        m_pipeline_data.resize(vertex_count);
-        _resize_z_buffer(m_window_ptr->GetWidth(), m_window_ptr->GetHeight());
-    #pragma endregion resizing-buffers
+        return outcode != 0;
+    }
 
-    #pragma region local-to-raster-coords
-        const auto shader_ptr = shader_engine._get_binded_shader_program().shader;
+    void _render_engine::_assemble_triangles(primitive_chunk& chunk, const size_t (*triangles)[3], size_t count) noexcept {
+        const uint32_t kept = m_cull_mode == cull_mode::NONE ? (1u << count) - 1 : _cull_triangles(chunk, triangles, count);
         
-        for (size_t i = 0, j = 0; j < vertex_count; i += vbo.element_size, ++j) {
-            m_pipeline_data[j].coord = std::move(shader_ptr->vertex(&vbo.data[i], m_pipeline_data[j].in_out_data));
-            
-            m_pipeline_data[j].clipped = !_is_inside_clip_space(m_pipeline_data[j].coord);
-            const vec4f ndc = m_pipeline_data[j].coord / m_pipeline_data[j].coord.w;
+        for (size_t t = 0; t < count; ++t) {
+            if ((kept & (1u << t)) != 0) {
+                _assemble_triangle(chunk, triangles[t][0], triangles[t][1], triangles[t][2]);
+            }
+        }
+    }
+
+    uint32_t _render_engine::_cull_triangles(const primitive_chunk& chunk, const size_t (*triangles)[3], size_t count) const noexcept {
+        if (m_cull_mode == cull_mode::FRONT_AND_BACK) {
+            return 0;
+        }
+
+        // (x, y, w) of the vertices of the batch, a lane per triangle, the unused lanes are zero
+        alignas(16) float x[3][CULL_BATCH_SIZE] = {}, y[3][CULL_BATCH_SIZE] = {}, w[3][CULL_BATCH_SIZE] = {};
+        for (size_t t = 0; t < count; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                const math::vec4f& clip_coord = chunk.vertices[triangles[t][k]].clip_coord;
+                x[k][t] = clip_coord.x;
+                y[k][t] = clip_coord.y;
+                w[k][t] = clip_coord.w;
+            }
+        }
+
+        uint32_t ccw = 0, cw = 0;
+        for (size_t t = 0; t < CULL_BATCH_SIZE; t += 4) {
+            const __m128 x0 = _mm_load_ps(x[0] + t), x1 = _mm_load_ps(x[1] + t), x2 = _mm_load_ps(x[2] + t);
+            const __m128 y0 = _mm_load_ps(y[0] + t), y1 = _mm_load_ps(y[1] + t), y2 = _mm_load_ps(y[2] + t);
+            const __m128 w0 = _mm_load_ps(w[0] + t), w1 = _mm_load_ps(w[1] + t), w2 = _mm_load_ps(w[2] + t);
+
+            // det [x y w], the doubled NDC area when every w is 1
+            const __m128 det = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(x0, _mm_sub_ps(_mm_mul_ps(y1, w2), _mm_mul_ps(w1, y2))),
+                _mm_mul_ps(y0, _mm_sub_ps(_mm_mul_ps(w1, x2), _mm_mul_ps(x1, w2)))),
+                _mm_mul_ps(w0, _mm_sub_ps(_mm_mul_ps(x1, y2), _mm_mul_ps(y1, x2))));
 
-            m_pipeline_data[j].coord = ndc * m_viewport.matrix;
-            m_pipeline_data[j].coord.x = std::floor(m_pipeline_data[j].coord.x);
-            m_pipeline_data[j].coord.y = std::floor(m_pipeline_data[j].coord.y);
+            ccw |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(det, _mm_setzero_ps()))) << t;
+            cw |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(det, _mm_setzero_ps()))) << t;
         }
-    #pragma endregion local-to-raster-coords
 
+        // edge-on triangles are in neither, they cover no pixel
+        const uint32_t front = m_front_face == winding::CCW ? ccw : cw;
+        const uint32_t back = m_front_face == winding::CCW ? cw : ccw;
+        return (m_cull_mode == cull_mode::BACK ? front : back) & ((1u << count) - 1);
+    }
 
+    void _render_engine::_assemble_triangle(primitive_chunk& chunk, size_t i0, size_t i1, size_t i2) noexcept {
+        const uint16_t outcode0 = chunk.vertices[i0].outcode, outcode1 = chunk.vertices[i1].outcode, outcode2 = chunk.vertices[i2].outcode;
 
+        // all the vertices are on the outer side of the same plane
+        if ((outcode0 & outcode1 & outcode2 & VIEW_VOLUME_OUTCODES) != 0) {
+            return;
+        }
 
+        const uint16_t planes = (outcode0 | outcode1 | outcode2) & CLIP_PLANE_OUTCODES;
+        if (planes == 0) {
+            _emit_triangle(chunk, i0, i1, i2, i2);
+            return;
+        }
 
-        switch (mode) {
-        case render_mode::POINTS:
-            for (size_t i = 0; i < vertex_count; ++i) {
-                if (!m_pipeline_data[i].clipped) {
-                    _render_pixel(m_pipeline_data[i].coord.xy, shader_ptr->pixel(m_pipeline_data[i].in_out_data));
-                }
-            }    
-            break;
-        
-        case render_mode::LINES:
-            for (size_t i = 1; i < ibo.data.size(); i += 2) {
-                m_thread_pool.AddTask(&_render_engine::_render_line, this, std::cref(m_pipeline_data[ibo.data[i - 1]]), std::cref(m_pipeline_data[ibo.data[i]]));
-            }
+    #pragma region sutherland-hodgman
+        size_t polygons[2][MAX_CLIPPED_VERTICES] = { { i0, i1, i2 } };
+        size_t vertex_count = 3;
+        size_t src = 0;
 
-            m_thread_pool.WaitAll();
-            break;
-        
-        case render_mode::LINE_STRIP: 
-            for (size_t i = 1; i < ibo.data.size(); ++i) {
-                m_thread_pool.AddTask(&_render_engine::_render_line, this, std::cref(m_pipeline_data[ibo.data[i - 1]]), std::cref(m_pipeline_data[ibo.data[i]]));
+        for (size_t p = 0; p < CLIP_PLANE_COUNT; ++p) {
+            if ((planes & (OUTSIDE_NEAR << p)) == 0) {
+                continue;
             }
 
-            m_thread_pool.WaitAll();
-            break;
+            const size_t* in = polygons[src];
+            size_t* out = polygons[src ^ 1];
+            size_t out_count = 0;
 
-        case render_mode::TRIANGLES:
+            for (size_t k = 0; k < vertex_count; ++k) {
+                const size_t a = in[k], b = in[(k + 1) % vertex_count];
+                const float da = dot(m_clip_planes[p], chunk.vertices[a].clip_coord);
+                const float db = dot(m_clip_planes[p], chunk.vertices[b].clip_coord);
 
-            for (size_t i = 2; i < ibo.data.size(); i += 3) {
-                const auto& PIPELINE_DATA0 = m_pipeline_data[ibo.data[i - 2]];
-                const auto& PIPELINE_DATA1 = m_pipeline_data[ibo.data[i - 1]];
-                const auto& PIPELINE_DATA2 = m_pipeline_data[ibo.data[i - 0]];
-                if (_is_front_face(PIPELINE_DATA0.coord.xyz, PIPELINE_DATA1.coord.xyz, PIPELINE_DATA2.coord.xyz)) {
-                    if (!PIPELINE_DATA0.clipped && !PIPELINE_DATA1.clipped && !PIPELINE_DATA2.clipped) {
-                        m_thread_pool.AddTask(&_render_engine::_render_polygon, this, std::cref(PIPELINE_DATA0), std::cref(PIPELINE_DATA1), std::cref(PIPELINE_DATA2));
-                    }
+                if (da >= 0.0f) {
+                    out[out_count++] = a;
+                }
+
+                // always interpolated from the inner vertex, so an edge shared by two triangles is cut at the same point
+                if ((da >= 0.0f) != (db >= 0.0f)) {
+                    out[out_count++] = da >= 0.0f ? _clip_vertex(chunk, a, b, da / (da - db)) : _clip_vertex(chunk, b, a, db / (db - da));
                 }
             }
 
-            m_thread_pool.WaitAll();
-            break;
+            vertex_count = out_count;
+            src ^= 1;
 
-        default:
-            ASSERT(false, "runtime", "invalid Rendering Mode");
-            break;
+            if (vertex_count < 3) {
+                return;
+            }
+        }
+    #pragma endregion sutherland-hodgman
+
+        const size_t* polygon = polygons[src];
+        for (size_t k = 1; k + 1 < vertex_count; ++k) {
+            _emit_triangle(chunk, polygon[0], polygon[k], polygon[k + 1], i2);
+        }
+    }
+
+    size_t _render_engine::_clip_vertex(primitive_chunk& chunk, size_t inside, size_t outside, float t) noexcept {
+        const size_t index = chunk.vertices.size();
+        const size_t components = m_varying_layout.components;
+
+        pipeline_metadata vertex;
+        vertex.clip_coord = chunk.vertices[inside].clip_coord + (chunk.vertices[outside].clip_coord - chunk.vertices[inside].clip_coord) * t;
+        vertex.outcode = _compute_outcode(vertex.clip_coord);
+        vertex.coord = (vertex.clip_coord / vertex.clip_coord.w) * m_viewport.matrix;
+        
+        chunk.vertices.push_back(vertex);
+        chunk.varyings.resize(chunk.varyings.size() + components);
+
+        const float* a = chunk.varyings.data() + inside * components;
+        const float* b = chunk.varyings.data() + outside * components;
+        float* dst = chunk.varyings.data() + index * components;
+
+        for (size_t i = 0; i < components; ++i) {
+            dst[i] = a[i] + (b[i] - a[i]) * t;
         }
+
+        return index;
     }
 
-    void _render_engine::_render_pixel(const math::vec2f& pixel, const math::color& color) const noexcept {
-        m_window_ptr->SetPixelColor(pixel.x, pixel.y, R_G_B_A(color));
+    void _render_engine::_emit_triangle(primitive_chunk& chunk, size_t v0, size_t v1, size_t v2, size_t provoking) noexcept {
+        triangle tri;
+        tri.v0 = v0;
+        tri.v1 = v1;
+        tri.v2 = v2;
+        tri.provoking = provoking;
+
+        if (_setup_triangle(chunk, tri)) {
+            chunk.triangles.push_back(tri);
+            _bin_triangle(chunk, chunk.triangles.size() - 1);
+        }
     }
 
-    void _render_engine::_render_line(const pipeline_metadata& v0, const pipeline_metadata& v1) const noexcept {
-        if (math::abs(v1.coord.y - v0.coord.y) < math::abs(v1.coord.x - v0.coord.x)) {
-            (v1.coord.x < v0.coord.x) ? _render_line_low(v1, v0) :  _render_line_low(v0, v1);
-        } else {
-            (v1.coord.y < v0.coord.y) ? _render_line_high(v1, v0) : _render_line_high(v0, v1);
+    const float* _render_engine::_varyings(const pipeline_metadata& vertex) const noexcept {
+        return m_varyings.data() + (&vertex - m_pipeline_data.data()) * m_varying_layout.components;
+    }
+
+    void _render_engine::_interpolate_varyings(const float* v0, const float* v1, const float* v2, float w0, float w1, float w2, pipeline_pack_type& pack) const noexcept {
+        const __m128 xmm_w0 = _mm_set1_ps(w0), xmm_w1 = _mm_set1_ps(w1), xmm_w2 = _mm_set1_ps(w2);
+
+        // smooth components come in whole slots, so there is no tail to handle
+        for (size_t i = 0; i < m_varying_layout.smooth_components; i += VARYING_SLOT_COMPONENTS) {
+            const __m128 v01 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(v0 + i), xmm_w0), _mm_mul_ps(_mm_loadu_ps(v1 + i), xmm_w1));
+            _mm_store_ps(pack.data + i, _mm_add_ps(v01, _mm_mul_ps(_mm_loadu_ps(v2 + i), xmm_w2)));
         }
     }
 
-    void _render_engine::_render_line_low(const pipeline_metadata& v0, const pipeline_metadata& v1) const noexcept {
-        using namespace math;
+    void _render_engine::_interpolate_quad_varyings(const float* v0, const float* v1, const float* v2, __m128 w0, __m128 w1, quad_pack_type& pack) const noexcept {
+        const __m128 w2 = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), w0), w1);
+        
+        for (size_t i = 0; i < m_varying_layout.smooth_components; ++i) {
+            const __m128 v01 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(v0[i]), w0), _mm_mul_ps(_mm_set1_ps(v1[i]), w1));
+            pack.smooth[i] = _mm_add_ps(v01, _mm_mul_ps(_mm_set1_ps(v2[i]), w2));
+        }
+    }
 
-        const auto& shader = shader_engine._get_binded_shader_program().shader;
+    void _render_engine::_copy_flat_varyings(const float* provoking, pipeline_pack_type& pack) const noexcept {
+        std::copy(provoking + m_varying_layout.smooth_components, provoking + m_varying_layout.components, pack.data + m_varying_layout.smooth_components);
+    }
+
+    bool _render_engine::_setup_triangle(const primitive_chunk& chunk, triangle& tri) const noexcept {
+        using namespace std;
+
+        const math::vec4f &c0 = chunk.vertices[tri.v0].coord, &c1 = chunk.vertices[tri.v1].coord, &c2 = chunk.vertices[tri.v2].coord;
+
+        int64_t x[3] = { llround(c0.x * SUBPIXEL_STEPS), llround(c1.x * SUBPIXEL_STEPS), llround(c2.x * SUBPIXEL_STEPS) };
+        int64_t y[3] = { llround(c0.y * SUBPIXEL_STEPS), llround(c1.y * SUBPIXEL_STEPS), llround(c2.y * SUBPIXEL_STEPS) };
+
+        int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area == 0) {
+            return false;
+        }
+
+        if (area < 0) {
+            swap(tri.v1, tri.v2);
+            swap(x[1], x[2]);
+            swap(y[1], y[2]);
+            area = -area;
+        }
+        tri.area = area;
+
+        const int64_t half_pixel = SUBPIXEL_STEPS / 2;
+        const int64_t sample_reach = m_render_target.sample_count == 1 ? 0 : MSAA_SAMPLE_REACH;
         
-        float dx = v1.coord.x - v0.coord.x;
-        float dy = v1.coord.y - v0.coord.y;
+        for (size_t i = 0; i < 3; ++i) {
+            const size_t j = (i + 1) % 3, k = (i + 2) % 3;
+            const int64_t dx = x[k] - x[j], dy = y[k] - y[j];
 
-        float yi = 1.0f;
+            // pixel centers lying exactly on an edge are covered only by its top or left side
+            const bool is_top_left = dy < 0 || (dy == 0 && dx > 0);
 
-        if (dy < 0.0f) {
-            yi = -1.0f;
-            dy = -dy;
+            tri.a[i] = -dy * SUBPIXEL_STEPS;
+            tri.b[i] = dx * SUBPIXEL_STEPS;
+            tri.c[i] = dx * (half_pixel - y[j]) - dy * (half_pixel - x[j]) - (is_top_left ? 0 : 1);
         }
 
-        const float v0_v1_dist = (v1.coord.xy - v0.coord.xy).length();
+        tri.min_x = max(static_cast<int32_t>((min(min(x[0], x[1]), x[2]) - half_pixel - sample_reach + SUBPIXEL_STEPS - 1) >> SUBPIXEL_BITS), 0);
+        tri.min_y = max(static_cast<int32_t>((min(min(y[0], y[1]), y[2]) - half_pixel - sample_reach + SUBPIXEL_STEPS - 1) >> SUBPIXEL_BITS), 0);
+        tri.max_x = min(static_cast<int32_t>((max(max(x[0], x[1]), x[2]) - half_pixel + sample_reach) >> SUBPIXEL_BITS), min(m_viewport.width, static_cast<int32_t>(m_render_target.width)) - 1);
+        tri.max_y = min(static_cast<int32_t>((max(max(y[0], y[1]), y[2]) - half_pixel + sample_reach) >> SUBPIXEL_BITS), min(m_viewport.height, static_cast<int32_t>(m_render_target.height)) - 1);
 
-        float D = (2.0f * dy) - dx;
-        float y = v0.coord.y;
+        tri.min_z = min(min(c0.z, c1.z), c2.z);
 
-        pipeline_pack_type pack;
+        tri.inv_w[0] = 1.0f / chunk.vertices[tri.v0].clip_coord.w;
+        tri.inv_w[1] = 1.0f / chunk.vertices[tri.v1].clip_coord.w;
+        tri.inv_w[2] = 1.0f / chunk.vertices[tri.v2].clip_coord.w;
 
-        for (float x = v0.coord.x; x <= v1.coord.x; ++x) {
-            const vec2f pixel(x, y);
-            
-            const float w0 = (pixel - v0.coord.xy).length() / v0_v1_dist;
-            const float w1 = 1.0f - w0;
+        const double inv_area = 1.0 / static_cast<double>(area);
+        for (size_t i = 0; i < 3; ++i) {
+            tri.w_dx[i] = static_cast<float>(tri.a[i] * inv_area);
+            tri.w_dy[i] = static_cast<float>(tri.b[i] * inv_area);
+        }
+
+        return tri.min_x <= tri.max_x && tri.min_y <= tri.max_y;
+    }
+
+    void _render_engine::_bin_triangle(primitive_chunk& chunk, size_t triangle_index) const noexcept {
+        const triangle& tri = chunk.triangles[triangle_index];
+        const int64_t sample_reach = m_render_target.sample_count == 1 ? 0 : MSAA_SAMPLE_REACH;
 
-            pack.clear();
-            for (auto& it0 = v0.in_out_data.cbegin(), &it1 = v1.in_out_data.cbegin(); it0 != v0.in_out_data.cend(); ++it0, ++it1) {
-                pack[it0->first] = std::visit(barycentric_interpolator<2>(vec2d(w1, w0), it0->second), it1->second);
+        const uint32_t tile_min_x = tri.min_x / TILE_SIZE, tile_max_x = tri.max_x / TILE_SIZE;
+        const uint32_t tile_min_y = tri.min_y / TILE_SIZE, tile_max_y = tri.max_y / TILE_SIZE;
+
+        for (uint32_t ty = tile_min_y; ty <= tile_max_y; ++ty) {
+            for (uint32_t tx = tile_min_x; tx <= tile_max_x; ++tx) {
+                const size_t tile_index = tx + ty * m_render_target.tiles_x;
+                const tile& tile = m_tiles[tile_index];
+
+                // the same corner test as for blocks: skip tiles of the bounding box which lie fully outside an edge
+                bool outside = false;
+                for (size_t i = 0; i < 3 && !outside; ++i) {
+                    const int64_t e = tri.a[i] * tile.x0 + tri.b[i] * tile.y0 + tri.c[i];
+                    const int64_t ext_sample = (std::abs(tri.a[i]) + std::abs(tri.b[i])) / SUBPIXEL_STEPS * sample_reach;
+                    
+                    outside = e + std::max<int64_t>(tri.a[i] * (tile.x1 - 1 - tile.x0), 0) + std::max<int64_t>(tri.b[i] * (tile.y1 - 1 - tile.y0), 0) + ext_sample < 0;
+                }
+
+                if (!outside) {
+                    chunk.bins.emplace_back(static_cast<uint32_t>(tile_index), static_cast<uint32_t>(triangle_index));
+                }
             }
-            _render_pixel(pixel, shader->pixel(pack));
-                
+        }
+    }
 
-            if (D > 0) {
-                y += yi;
-                D += 2.0f * (dy - dx);
-            } else {
-                D += 2.0f * dy;
+    void _render_engine::_assemble_line(primitive_chunk& chunk, size_t i0, size_t i1) noexcept {
+        const uint16_t outcode0 = chunk.vertices[i0].outcode, outcode1 = chunk.vertices[i1].outcode;
+        if ((outcode0 & outcode1 & VIEW_VOLUME_OUTCODES) != 0) {
+            return;
+        }
+
+    #pragma region liang-barsky
+        // the part of i0 -> i1 inside every plane is [t0, t1]
+        float t0 = 0.0f, t1 = 1.0f;
+        
+        const uint16_t planes = (outcode0 | outcode1) & CLIP_PLANE_OUTCODES;
+        for (size_t p = 0; p < CLIP_PLANE_COUNT; ++p) {
+            if ((planes & (OUTSIDE_NEAR << p)) == 0) {
+                continue;
+            }
+
+            const float d0 = dot(m_clip_planes[p], chunk.vertices[i0].clip_coord);
+            const float d1 = dot(m_clip_planes[p], chunk.vertices[i1].clip_coord);
+            
+            if (d0 < 0.0f && d1 < 0.0f) {
+                return;
+            } else if (d0 < 0.0f) {
+                t0 = std::max(t0, d0 / (d0 - d1));
+            } else if (d1 < 0.0f) {
+                t1 = std::min(t1, d0 / (d0 - d1));
             }
         }
+
+        if (t0 >= t1) {
+            return;
+        }
+    #pragma endregion liang-barsky
+
+        line line;
+        line.v0 = t0 > 0.0f ? _clip_vertex(chunk, i0, i1, t0) : i0;
+        line.v1 = t1 < 1.0f ? _clip_vertex(chunk, i0, i1, t1) : i1;
+        line.provoking = i1;
+
+        if (_setup_line(chunk, line)) {
+            chunk.lines.push_back(line);
+            _bin_line(chunk, chunk.lines.size() - 1);
+        }
     }
 
-    void _render_engine::_render_line_high(const pipeline_metadata& v0, const pipeline_metadata& v1) const noexcept {
-        using namespace math;
+    bool _render_engine::_setup_line(const primitive_chunk& chunk, line& line) const noexcept {
+        using namespace std;
 
-        const auto& shader = shader_engine._get_binded_shader_program().shader;
+        line.is_x_major = abs(chunk.vertices[line.v1].coord.x - chunk.vertices[line.v0].coord.x) >= abs(chunk.vertices[line.v1].coord.y - chunk.vertices[line.v0].coord.y);
+        const size_t major_axis = line.is_x_major ? 0 : 1;
         
-        float dx = v1.coord.x - v0.coord.x;
-        float dy = v1.coord.y - v0.coord.y;
+        if (chunk.vertices[line.v1].coord[major_axis] < chunk.vertices[line.v0].coord[major_axis]) {
+            swap(line.v0, line.v1);
+        }
 
-        float xi = 1.0f;
+        const math::vec4f &c0 = chunk.vertices[line.v0].coord, &c1 = chunk.vertices[line.v1].coord;
+        const float major0 = c0[major_axis], major1 = c1[major_axis];
+        const float minor0 = c0[major_axis ^ 1], minor1 = c1[major_axis ^ 1];
 
-        if (dx < 0.0f) {
-            xi = -1.0f;
-            dx = -dx;
+        // shorter than a pixel along both axes, it covers no pixel center
+        if (!(major1 - major0 > 0.0f)) {
+            return false;
         }
 
-        const float v0_v1_dist = (v1.coord.xy - v0.coord.xy).length();
+        const float inv_length = 1.0f / (major1 - major0);
+        line.t_step = inv_length;
+        line.t_origin = (0.5f - major0) * inv_length;
+        line.minor_step = (minor1 - minor0) * inv_length;
+        line.minor_origin = minor0 + (0.5f - major0) * line.minor_step;
 
-        float D = (2.0f * dx) - dy;
-        float x = v0.coord.x;
+        line.z0 = c0.z;
+        line.dz = c1.z - c0.z;
+        line.min_z = min(c0.z, c1.z);
+        line.inv_w[0] = 1.0f / chunk.vertices[line.v0].clip_coord.w;
+        line.inv_w[1] = 1.0f / chunk.vertices[line.v1].clip_coord.w;
 
-        pipeline_pack_type pack;
+        const int32_t major_extent = min(line.is_x_major ? m_viewport.width : m_viewport.height, 
+            static_cast<int32_t>(line.is_x_major ? m_render_target.width : m_render_target.height));
+        
+        // the pixel centers in [major0, major1)
+        line.min_major = max(static_cast<int32_t>(ceil(major0 - 0.5f)), 0);
+        line.max_major = min(static_cast<int32_t>(ceil(major1 - 0.5f)) - 1, major_extent - 1);
 
-        for (float y = v0.coord.y; y <= v1.coord.y; ++y) {
-            const vec2f pixel(x, y);
-            
-            const float w0 = (pixel - v0.coord.xy).length() / v0_v1_dist;
-            const float w1 = 1.0f - w0;
+        return line.min_major <= line.max_major;
+    }
 
-            pack.clear();
-            for (auto& it0 = v0.in_out_data.cbegin(), &it1 = v1.in_out_data.cbegin(); it0 != v0.in_out_data.cend(); ++it0, ++it1) {
-                pack[it0->first] = std::visit(barycentric_interpolator<2>(vec2d(w1, w0), it0->second), it1->second);
-            }
-            _render_pixel(pixel, shader->pixel(pack));
+    void _render_engine::_bin_line(primitive_chunk& chunk, size_t line_index) const noexcept {
+        const line& line = chunk.lines[line_index];
 
-            if (D > 0) {
-                x += xi;
-                D += 2.0f * (dx - dy);
-            } else {
-                D += 2.0f * dx;
+        const int32_t tiles_major = line.is_x_major ? m_render_target.tiles_x : m_render_target.tiles_y;
+        const int32_t tiles_minor = line.is_x_major ? m_render_target.tiles_y : m_render_target.tiles_x;
+
+        // the minor pixels of the line over the tile's span of the major axis, widened by a pixel for the 
+        // antialiased ones and for the rounding of the stepping
+        for (int32_t major_tile = line.min_major / TILE_SIZE; major_tile <= line.max_major / TILE_SIZE; ++major_tile) {
+            const int32_t first = std::max(line.min_major, major_tile * static_cast<int32_t>(TILE_SIZE));
+            const int32_t last = std::min(line.max_major, (major_tile + 1) * static_cast<int32_t>(TILE_SIZE) - 1);
+            
+            const float minor_first = line.minor_origin + line.minor_step * first, minor_last = line.minor_origin + line.minor_step * last;
+            const int32_t min_minor = static_cast<int32_t>(std::floor(std::min(minor_first, minor_last))) - 1;
+            const int32_t max_minor = static_cast<int32_t>(std::floor(std::max(minor_first, minor_last))) + 1;
+            
+            const int32_t min_minor_tile = std::max(min_minor, 0) / static_cast<int32_t>(TILE_SIZE);
+            const int32_t max_minor_tile = std::min(max_minor / static_cast<int32_t>(TILE_SIZE), tiles_minor - 1);
+
+            for (int32_t minor_tile = min_minor_tile; minor_tile <= max_minor_tile && major_tile < tiles_major; ++minor_tile) {
+                const int32_t tile_index = line.is_x_major ? major_tile + minor_tile * tiles_major : minor_tile + major_tile * tiles_minor;
+                chunk.bins.emplace_back(static_cast<uint32_t>(tile_index), static_cast<uint32_t>(line_index));
             }
         }
     }
 
-    void _render_engine::_render_polygon(const pipeline_metadata& v0, const pipeline_metadata& v1, const pipeline_metadata& v2) noexcept {
-        using namespace math;
-        using namespace std;
-
-        const auto& shader = shader_engine._get_binded_shader_program().shader;
+    void _render_engine::_sort_bins(primitive_chunk& chunk) const noexcept {
+        // counting sort by tile, stable, so every tile still sees the chunk primitives in submission order
+        chunk.tile_offsets.assign(m_tiles.size() + 1, 0);
+        chunk.tile_primitives.resize(chunk.bins.size());
 
-        const vec2f bboxmin(round(min(min(v0.coord.x, v1.coord.x), v2.coord.x)), round(min(min(v0.coord.y, v1.coord.y), v2.coord.y)));
-        const vec2f bboxmax(round(max(max(v0.coord.x, v1.coord.x), v2.coord.x)), round(max(max(v0.coord.y, v1.coord.y), v2.coord.y)));
+        for (const auto& bin : chunk.bins) {
+            ++chunk.tile_offsets[bin.first + 1];
+        }
 
-        pipeline_pack_type pack;
-        const double area = _edge(v0.coord.xy, v1.coord.xy, v2.coord.xy);
+        for (size_t i = 1; i < chunk.tile_offsets.size(); ++i) {
+            chunk.tile_offsets[i] += chunk.tile_offsets[i - 1];
+        }
 
-        // bool prev_y_was_inside = false;
-        for (float y = bboxmin.y; y <= bboxmax.y; ++y) {
-            // if (_is_inside_viewport_space_vertic(y)) {
-                // prev_y_was_inside = true;
+        for (const auto& bin : chunk.bins) {
+            chunk.tile_primitives[chunk.tile_offsets[bin.first]++] = bin.second;
+        }
 
-                // bool prev_x_was_inside = false;
-                for (float x = bboxmin.x; x <= bboxmax.x; ++x) {
-                    // if (_is_inside_viewport_space_horiz(x)) {
-                        // prev_x_was_inside = true;
+        // the scatter has moved every offset to the end of its tile, shift them back to the beginnings
+        for (size_t i = chunk.tile_offsets.size() - 1; i > 0; --i) {
+            chunk.tile_offsets[i] = chunk.tile_offsets[i - 1];
+        }
+        chunk.tile_offsets[0] = 0;
+    }
 
-                        vec3f pixel(x, y, 0.0);
-                    
-                        const double w0 = _edge(v1.coord.xy, v2.coord.xy, pixel.xy) / area;
-                        const double w1 = _edge(v2.coord.xy, v0.coord.xy, pixel.xy) / area;
-                        const double w2 = 1.0 - w0 - w1;
-                        
-                        if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
-                            // prev_x_was_inside = true;
+    void _render_engine::_rasterize_tiles(bool lines) noexcept {
+        _parallel_for(m_tiles.size(), [this, lines](size_t tile_index) {
+            _rasterize_tile(tile_index, lines);
+        });
+    }
 
-                            pixel.z = 1.0f / ((1.0f / v0.coord.z) * w0 + (1.0f / v1.coord.z) * w1 + (1.0f / v2.coord.z) * w2);
-                            if (_test_and_update_depth(pixel)) {
-                                pack.clear();
+    void _render_engine::_rasterize_tile(size_t tile_index, bool lines) noexcept {
+        tile& tile = m_tiles[tile_index];
 
-                                auto& it0 = v0.in_out_data.cbegin(), &it1 = v1.in_out_data.cbegin(), &it2 = v2.in_out_data.cbegin();
-                                for (; it0 != v0.in_out_data.cend(); ++it0, ++it1, ++it2) {
-                                    pack[it0->first] = std::visit(barycentric_interpolator<3>(vec3d(w0, w1, w2), it0->second, it1->second), it2->second);
-                                }
-                                _render_pixel(pixel.xy, shader->pixel(pack));
-                            }
-                        }
-                    // } else if (prev_x_was_inside) {
-                    //     break;
-                    // }
+        // chunks are walked in submission order, which keeps the draw order of overlapping primitives intact
+        for (uint32_t c = 0; c < m_chunk_count; ++c) {
+            const primitive_chunk& chunk = m_chunks[c];
+            
+            for (uint32_t k = chunk.tile_offsets[tile_index]; k < chunk.tile_offsets[tile_index + 1]; ++k) {
+                _materialize_tile(tile_index);
+
+                if (lines) {
+                    if (m_render_target.sample_count == 1) {
+                        _render_line<1>(c, chunk.tile_primitives[k], tile);
+                    } else {
+                        _render_line<MSAA_SAMPLE_COUNT>(c, chunk.tile_primitives[k], tile);
+                    }
+                } else if (m_render_target.sample_count == 1) {
+                    _render_polygon<1>(c, chunk.tile_primitives[k], tile);
+                } else {
+                    _render_polygon<MSAA_SAMPLE_COUNT>(c, chunk.tile_primitives[k], tile);
                 }
-            // } else if (prev_y_was_inside) {
-            //     break;
-            // }
+            }
         }
+
+        // the tile is owned by this worker till the end, so it can be shaded right after its depth is final
+        _shade_visible_samples(tile_index);
     }
 
-    void _render_engine::_resize_z_buffer(uint32_t width, uint32_t height) noexcept {
-        m_z_buffer.resize(width * height, math::MATH_INFINITY);
+    void _render_engine::_resolve_tiles() noexcept {
+        _parallel_for(m_tiles.size(), [this](size_t tile_index) {
+            const tile& tile = m_tiles[tile_index];
+
+            for (uint32_t y = tile.y0; y < tile.y1; ++y) {
+                const uint32_t* src = &m_color_buffer[_pixel_index(tile.x0, y)];
+                uint32_t* dst = &m_present_buffer[tile.x0 + y * m_render_target.width];
+                
+                // a tile nothing was drawn to is resolved without reading its storage
+                if (tile.is_color_cleared) {
+                    std::fill(dst, dst + (tile.x1 - tile.x0), tile.clear_color);
+                    continue;
+                }
+
+                if (m_render_target.sample_count == 1) {
+                    std::copy(src, src + (tile.x1 - tile.x0), dst);
+                    continue;
+                }
+
+                // the box filter over the 4 sample planes, 4 pixels at once: the channels are summed in 16 bits and rounded once. 
+                // Tile rows are always TILE_SIZE pixels long, so the last vector may read past x1, but not past the tile
+                static_assert(MSAA_SAMPLE_COUNT == 4, "the sum is rounded and divided by shifting");
+                for (uint32_t x = 0; x < tile.x1 - tile.x0; x += 4) {
+                    const __m128i zero = _mm_setzero_si128();
+                    __m128i sum_lo = _mm_set1_epi16(2), sum_hi = _mm_set1_epi16(2);
+                    
+                    for (uint32_t s = 0; s < MSAA_SAMPLE_COUNT; ++s) {
+                        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + s * TILE_PIXEL_COUNT));
+                        sum_lo = _mm_add_epi16(sum_lo, _mm_unpacklo_epi8(samples, zero));
+                        sum_hi = _mm_add_epi16(sum_hi, _mm_unpackhi_epi8(samples, zero));
+                    }
+                    
+                    alignas(16) uint32_t resolved[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(resolved), _mm_packus_epi16(_mm_srli_epi16(sum_lo, 2), _mm_srli_epi16(sum_hi, 2)));
+                    std::copy(resolved, resolved + std::min(4u, tile.x1 - tile.x0 - x), dst + x);
+                }
+            }
+        });
     }
 
-    bool _render_engine::_test_and_update_depth(const math::vec3f& pixel) noexcept {
-        const size_t idx = std::round(pixel.x + pixel.y * m_window_ptr->GetWidth());
-        if (pixel.z <= m_z_buffer[idx]) {
-            m_z_buffer[idx] = pixel.z;
-            return true; 
+    void _render_engine::_resize_render_target(uint32_t width, uint32_t height) noexcept {
+        if (m_render_target.width == width && m_render_target.height == height && m_render_target.sample_count == m_sample_count) {
+            return;
         }
 
-        return false;
-    }
+        m_render_target.width = width;
+        m_render_target.height = height;
+        m_render_target.sample_count = m_sample_count;
+        m_render_target.tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+        m_render_target.tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
 
-    bool _render_engine::_is_inside_clip_space(const math::vec4f &coord) const noexcept {
-        return math::between(coord.x, -coord.w, coord.w) && math::between(coord.y, -coord.w, coord.w) && math::between(coord.z, -coord.w, coord.w);
+        const size_t tile_count = m_render_target.tiles_x * m_render_target.tiles_y;
+
+        m_tiles.resize(tile_count);
+        for (uint32_t ty = 0; ty < m_render_target.tiles_y; ++ty) {
+            for (uint32_t tx = 0; tx < m_render_target.tiles_x; ++tx) {
+                tile& tile = m_tiles[tx + ty * m_render_target.tiles_x];
+                
+                tile.x0 = tx * TILE_SIZE;
+                tile.y0 = ty * TILE_SIZE;
+                tile.x1 = std::min(tile.x0 + TILE_SIZE, width);
+                tile.y1 = std::min(tile.y0 + TILE_SIZE, height);
+                // the G-buffer is reallocated by the next draw, the old masks may name samples which are gone
+                tile.has_gbuffer_samples = false;
+                tile.max_z = math::MATH_INFINITY;
+                tile.is_depth_cleared = true;
+                tile.is_color_cleared = true;
+                tile.clear_color = _pack_color(R_G_B_A(m_clear_color));
+            }
+        }
+        m_gbuffer.clear();
+        m_gbuffer_owner.clear();
+        m_gbuffer_mask.clear();
+
+        // the tiles are cleared, what the storage holds does not matter
+        m_z_buffer.resize(tile_count * TILE_PIXEL_COUNT * m_sample_count);
+        m_block_max_z.resize(tile_count * TILE_BLOCK_COUNT);
+        m_color_buffer.resize(tile_count * TILE_PIXEL_COUNT * m_sample_count);
+        m_present_buffer.resize(width * height);
     }
 
-    bool _render_engine::_is_front_face(const math::vec3f &v0, const math::vec3f &v1, const math::vec3f &v2) const noexcept {
-        static const math::vec3f& backward = math::vec3f::BACKWARD();
-        
-        const math::vec3f n = normalize(cross(v1 - v0, v2 - v0));
-        return dot(n, backward) > 0.0f;
+    size_t _render_engine::_pixel_index(uint32_t x, uint32_t y) const noexcept {
+        // of sample 0, sample s is TILE_PIXEL_COUNT * s further
+        const size_t tile_index = (x / TILE_SIZE) + (y / TILE_SIZE) * m_render_target.tiles_x;
+        return tile_index * TILE_PIXEL_COUNT * m_render_target.sample_count + (x % TILE_SIZE) + (y % TILE_SIZE) * TILE_SIZE;
     }
 
-    double _render_engine::_edge(const math::vec2f &v0, const math::vec2f &v1, const math::vec2f &p) noexcept {
-        return static_cast<double>((p.x - v0.x) * (v1.y - v0.y) - (p.y - v0.y) * (v1.x - v0.x));
+    uint32_t _render_engine::_pack_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) noexcept {
+        // the same byte order as the window's pixel buffer: r, g, b, a in memory
+        return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) << 24);
     }
 
     _render_engine &_render_engine::get() noexcept {
@@ -286,7 +1741,7 @@ namespace gl {
         }
 
         m_window_ptr = window;
-        _resize_z_buffer(window->GetWidth(), window->GetHeight());
+        _resize_render_target(window->GetWidth(), window->GetHeight());
         return true;
     }
 
@@ -302,15 +1757,213 @@ namespace gl {
     }
 
     void _render_engine::swap_buffers() noexcept {
+        resolve_frame();
+        present_frame();
+    }
+
+    void _render_engine::resolve_frame() noexcept {
+        ASSERT(m_binded_framebuffer == 0, "render engine error", "the window is to be bound back before the frame is resolved");
+        _update_render_target();
+        _resolve_tiles();
+
+        const size_t staged = 1 - m_staged_buffer.load();
+        std::swap(m_present_buffer, m_staging_buffers[staged]);
+        m_present_buffer.resize(m_staging_buffers[staged].size());
+        m_staged_buffer.store(staged);
+        
+        clear_color_buffer();
+
+        // nothing samples textures between frames, the pages loaded meanwhile can be made resident
+        tex_engine._update_pages();
+    }
+
+    void _render_engine::present_frame() noexcept {
+        const std::vector<uint32_t>& staging_buffer = m_staging_buffers[m_staged_buffer.load()];
+        
+        // a frame resolved before the window was resized is dropped
+        if (staging_buffer.size() != static_cast<size_t>(m_window_ptr->GetWidth()) * m_window_ptr->GetHeight()) {
+            return;
+        }
+
+        m_window_ptr->FillPixelBuffer(staging_buffer);
         m_window_ptr->PresentPixelBuffer();
-        m_window_ptr->FillPixelBuffer(R_G_B_A(m_clear_color));
     }
 
+    // clears only flag the tiles, the storage of the ones drawn to afterwards is cleared by _materialize_tile
     void _render_engine::clear_depth_buffer() noexcept {
-        std::fill(m_z_buffer.begin(), m_z_buffer.end(), math::MATH_INFINITY);
+        for (tile& tile : m_tiles) {
+            tile.max_z = math::MATH_INFINITY;
+            tile.is_depth_cleared = true;
+        }
+    }
+
+    void _render_engine::clear_color_buffer() noexcept {
+        const uint32_t clear_color = _pack_color(R_G_B_A(m_clear_color));
+        for (tile& tile : m_tiles) {
+            tile.is_color_cleared = true;
+            tile.clear_color = clear_color;
+        }
+    }
+
+    void _render_engine::_materialize_tile(size_t tile_index) noexcept {
+        tile& tile = m_tiles[tile_index];
+        const size_t tile_samples = TILE_PIXEL_COUNT * m_render_target.sample_count;
+
+        if (tile.is_depth_cleared) {
+            float* z_tile = &m_z_buffer[tile_index * tile_samples];
+            std::fill(z_tile, z_tile + tile_samples, math::MATH_INFINITY);
+            
+            float* block_max_z = &m_block_max_z[tile_index * TILE_BLOCK_COUNT];
+            std::fill(block_max_z, block_max_z + TILE_BLOCK_COUNT, math::MATH_INFINITY);
+            tile.is_depth_cleared = false;
+        }
+
+        if (tile.is_color_cleared) {
+            uint32_t* color_tile = &m_color_buffer[tile_index * tile_samples];
+            std::fill(color_tile, color_tile + tile_samples, tile.clear_color);
+            tile.is_color_cleared = false;
+        }
+    }
+
+    size_t _render_engine::create_framebuffer(uint32_t width, uint32_t height) noexcept {
+        ASSERT(width > 0 && height > 0, "render engine error", "a framebuffer can not be empty");
+        
+        // the storage is allocated by the first bind
+        framebuffer framebuffer;
+        framebuffer.width = width;
+        framebuffer.height = height;
+        return m_framebuffers.insert(std::move(framebuffer));
+    }
+
+    void _render_engine::delete_framebuffer(size_t id) noexcept {
+        // the bound framebuffer gives the window back, without copying into its attachments
+        if (id != 0 && id == m_binded_framebuffer) {
+            _swap_framebuffer(m_framebuffers.get(id));
+            _swap_framebuffer(m_window_framebuffer);
+            m_binded_framebuffer = 0;
+        }
+        m_framebuffers.erase(id);
+    }
+
+    void _render_engine::bind_framebuffer(size_t id) noexcept {
+        ASSERT(id == 0 || m_framebuffers.contains(id), "render engine error", "invalid framebuffer ID");
+        if (id == m_binded_framebuffer) {
+            return;
+        }
+
+        if (m_binded_framebuffer != 0) {
+            _copy_attachments(m_framebuffers.get(m_binded_framebuffer));
+        }
+        _swap_framebuffer(m_binded_framebuffer == 0 ? m_window_framebuffer : m_framebuffers.get(m_binded_framebuffer));
+
+        m_binded_framebuffer = id;
+        _swap_framebuffer(id == 0 ? m_window_framebuffer : m_framebuffers.get(id));
+        
+        if (id != 0) {
+            _update_render_target();
+        }
+    }
+
+    void _render_engine::attach_color_texture(size_t framebuffer, size_t texture) noexcept {
+        _ASSERT_FRAMEBUFFER_ID_VALIDITY(m_framebuffers, framebuffer);
+        _ASSERT_ATTACHMENT_VALIDITY(m_framebuffers.get(framebuffer), texture, texture_format::RGBA8);
+        m_framebuffers.get(framebuffer).color_texture = texture;
+    }
+
+    void _render_engine::attach_depth_texture(size_t framebuffer, size_t texture) noexcept {
+        _ASSERT_FRAMEBUFFER_ID_VALIDITY(m_framebuffers, framebuffer);
+        _ASSERT_ATTACHMENT_VALIDITY(m_framebuffers.get(framebuffer), texture, texture_format::DEPTH32F);
+        m_framebuffers.get(framebuffer).depth_texture = texture;
+    }
+
+    void _render_engine::_swap_framebuffer(framebuffer& storage) noexcept {
+        m_z_buffer.swap(storage.z_buffer);
+        m_block_max_z.swap(storage.block_max_z);
+        m_color_buffer.swap(storage.color_buffer);
+        m_visibility_buffer.swap(storage.visibility_buffer);
+        m_gbuffer.swap(storage.gbuffer);
+        m_gbuffer_owner.swap(storage.gbuffer_owner);
+        m_gbuffer_mask.swap(storage.gbuffer_mask);
+        m_present_buffer.swap(storage.present_buffer);
+        std::swap(m_render_target, storage.target);
+        m_tiles.swap(storage.tiles);
+    }
+
+    void _render_engine::_update_render_target() noexcept {
+        if (m_binded_framebuffer == 0) {
+            _resize_render_target(m_window_ptr->GetWidth(), m_window_ptr->GetHeight());
+        } else {
+            const framebuffer& framebuffer = m_framebuffers.get(m_binded_framebuffer);
+            _resize_render_target(framebuffer.width, framebuffer.height);
+        }
+    }
+
+    void _render_engine::_copy_attachments(const framebuffer& framebuffer) noexcept {
+        // the present buffer is the row major staging of both
+        if (framebuffer.color_texture != 0) {
+            _resolve_tiles();
+            tex_engine._update_render_texture(framebuffer.color_texture, m_present_buffer.data());
+        }
+
+        if (framebuffer.depth_texture != 0) {
+            uint32_t cleared_depth;
+            std::memcpy(&cleared_depth, &math::MATH_INFINITY, sizeof(float));
+
+            // sample 0 of every pixel
+            _parallel_for(m_tiles.size(), [this, cleared_depth](size_t tile_index) {
+                const tile& tile = m_tiles[tile_index];
+                
+                for (uint32_t y = tile.y0; y < tile.y1; ++y) {
+                    uint32_t* dst = &m_present_buffer[tile.x0 + y * m_render_target.width];
+                    
+                    if (tile.is_depth_cleared) {
+                        std::fill(dst, dst + (tile.x1 - tile.x0), cleared_depth);
+                    } else {
+                        std::memcpy(dst, &m_z_buffer[_pixel_index(tile.x0, y)], (tile.x1 - tile.x0) * sizeof(float));
+                    }
+                }
+            });
+            tex_engine._update_render_texture(framebuffer.depth_texture, m_present_buffer.data());
+        }
     }
 
     void _render_engine::set_clear_color(const math::color& color) noexcept {
         m_clear_color = color;
     }
+
+    void _render_engine::set_shading_mode(shading_mode mode) noexcept {
+        m_shading_mode = mode;
+    }
+
+    void _render_engine::set_sample_count(uint32_t count) noexcept {
+        ASSERT(count == 1 || count == MSAA_SAMPLE_COUNT, "render engine error", "unsupported sample count");
+        m_sample_count = count;
+    }
+
+    void _render_engine::set_line_antialiasing(bool enabled) noexcept {
+        m_line_antialiasing = enabled;
+    }
+
+    void _render_engine::set_cull_mode(cull_mode mode) noexcept {
+        m_cull_mode = mode;
+    }
+
+    void _render_engine::set_front_face(winding front_face) noexcept {
+        m_front_face = front_face;
+    }
+
+    void _render_engine::set_point_lights(const point_light* lights, size_t count) noexcept {
+        m_point_lights.assign(lights, lights + count);
+    }
+
+    void _render_engine::set_ambient_light(const math::color& color) noexcept {
+        m_ambient_light = color;
+    }
+
+    void _render_engine::render_lights(const math::vec3f& camera_position) noexcept {
+        // tiles are lit independently, each against the lights touching what it shows
+        _parallel_for(m_tiles.size(), [&](size_t tile_index) {
+            _light_tile(tile_index, camera_position);
+        });
+    }
 }
\ No newline at end of file
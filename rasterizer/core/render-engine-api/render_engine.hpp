@@ -4,17 +4,108 @@
 
 #include "math_3d/math.hpp"
 #include "core/assert_macro.hpp"
+#include "core/slot_map.hpp"
 
-#include <unordered_map>
-#include <variant>
+#include <atomic>
+#include <algorithm>
 
 namespace gl {
-    enum class render_mode : uint8_t { POINTS, LINES, LINE_STRIP, TRIANGLES };
+    class _shader;
+
+    // the strips take primitive restart indices, see index_format
+    enum class render_mode : uint8_t { POINTS, LINES, LINE_STRIP, TRIANGLES, TRIANGLE_STRIP };
+    enum class interpolation : uint8_t { SMOOTH, FLAT };
+    
+    /**
+     * FORWARD shades every pixel that passes the depth test when it is rasterized. 
+     * DEFERRED rasterizes TRIANGLES into a visibility buffer first and then shades 
+     * every visible pixel of the draw exactly once, however big the overdraw is.
+     * GBUFFER does the same, but the visible pixels write _shader::surface into the 
+     * G-buffer, which is lit later by render_lights.
+    */
+    enum class shading_mode : uint8_t { FORWARD, DEFERRED, GBUFFER };
+
+    /**
+     * Like glCullFace and glFrontFace: the triangles facing 'cull_mode' are dropped, the front ones are those 
+     * winding counterclockwise (or clockwise) on the screen. Points and lines are never culled.
+    */
+    enum class cull_mode : uint8_t { NONE, FRONT, BACK, FRONT_AND_BACK };
+    enum class winding : uint8_t { CCW, CW };
+
+    /**
+     * A surface of the G-buffer, world space. A zero normal marks a surface 
+     * which takes no lighting, its albedo is output as it is.
+    */
+    struct gbuffer_sample {
+        math::color albedo;
+        math::vec3f position;
+        math::vec3f normal;
+        float shininess = 0.0f;
+    };
+
+    // fades out smoothly with the distance and lights nothing farther than 'radius'
+    struct point_light {
+        math::vec3f position;
+        float radius = 1.0f;
+        math::color color = math::color::WHITE;
+        float intensity = 1.0f;
+    };
 
     class _render_engine final {
     public:
-        using pipeline_data_type = std::variant<math::vec2f, math::vec3f, math::vec4f, math::mat4f>;
-        using pipeline_pack_type = std::unordered_map<std::string, pipeline_data_type>;
+        /**
+         * Varyings are stored like GLSL's layout(location = N): every location is a 4-float slot 
+         * (mat4f takes 4 of them). Smooth varyings are packed first, so they are interpolated as one 
+         * contiguous run of floats, flat ones follow and are copied from the provoking (last) vertex.
+        */
+        static constexpr size_t MAX_VARYING_LOCATIONS = 16;
+        static constexpr size_t VARYING_SLOT_COMPONENTS = 4;
+
+        static constexpr uint32_t MSAA_SAMPLE_COUNT = 4;
+
+        struct pipeline_pack_type {
+            alignas(16) float data[MAX_VARYING_LOCATIONS * VARYING_SLOT_COMPONENTS];
+
+            // what ddx and ddy are made of: the varyings of the triangle's vertices and the screen space derivatives 
+            // of the perspective correct weights of the first two. nullptr when the primitive is not a triangle
+            const float* vertex_varyings[3] = { nullptr, nullptr, nullptr };
+            float dw_dx[2] = { 0.0f, 0.0f };
+            float dw_dy[2] = { 0.0f, 0.0f };
+
+            // the attributes of the vertex being shaded by location, nullptr when the vertex buffer has no attribute layout
+            const __m128* attributes = nullptr;
+        };
+
+        /**
+         * The varyings of a 2x2 quad, for _shader::pixel_quad: smooth components are SoA, a lane per pixel, 
+         * flat ones are the same for the whole quad and are kept at their offsets as in pipeline_pack_type.
+        */
+        struct quad_pack_type {
+            __m128 smooth[MAX_VARYING_LOCATIONS * VARYING_SLOT_COMPONENTS];
+            alignas(16) float data[MAX_VARYING_LOCATIONS * VARYING_SLOT_COMPONENTS];
+        };
+
+        /**
+         * Four vertices for _shader::vertex_quad, SoA with a lane per vertex: component c of the attribute at location l 
+         * is attributes[l * 4 + c], component i of the varyings is data[i], i counted as in pipeline_pack_type.
+        */
+        struct vertex_quad_pack_type {
+            __m128 data[MAX_VARYING_LOCATIONS * VARYING_SLOT_COMPONENTS];
+            const __m128* attributes = nullptr;
+        };
+
+        struct varying_layout {
+            struct varying {
+                size_t type_hash = 0;
+                size_t slots = 0;
+                interpolation qualifier = interpolation::SMOOTH;
+                size_t offset = 0;
+            };
+
+            varying varyings[MAX_VARYING_LOCATIONS];
+            size_t smooth_components = 0;
+            size_t components = 0;
+        };
 
         _render_engine(const _render_engine& engine) = delete;
         _render_engine& operator=(const _render_engine& engine) = delete;
@@ -27,128 +118,381 @@ namespace gl {
         void viewport(uint32_t width, uint32_t height) noexcept;
 
         void render(render_mode mode) noexcept;
+        void render_instanced(render_mode mode, size_t instance_count) noexcept;
+        // resolve_frame followed by present_frame, on the calling thread
         void swap_buffers() noexcept;
+        /**
+         * Split swap_buffers for the command engine: resolve_frame is recorded at the end of a frame and stages the window's 
+         * color, present_frame shows the frame staged last and is called from the main thread, as SDL is to be. Two frames 
+         * are staged in turns, so one can be presented while the next one is drawn, but not while a third one is resolved.
+        */
+        void resolve_frame() noexcept;
+        void present_frame() noexcept;
         void clear_depth_buffer() noexcept;
+        void clear_color_buffer() noexcept;
+
+        /**
+         * Offscreen render targets of any size, independent of the window. While a framebuffer is bound everything 
+         * is drawn into its own color and depth, 0 binds the window back, which swap_buffers presents. 
+         * The window's color is cleared by swap_buffers, a framebuffer's by clear_color_buffer only.
+        */
+        size_t create_framebuffer(uint32_t width, uint32_t height) noexcept;
+        void delete_framebuffer(size_t id) noexcept;
+        void bind_framebuffer(size_t id) noexcept;
+
+        /**
+         * Render to texture: whenever the framebuffer is unbound its resolved color and its depth are copied into 
+         * these textures of the same size, made by _texture_engine::create_render_texture as RGBA8 and DEPTH32F. 0 detaches.
+        */
+        void attach_color_texture(size_t framebuffer, size_t texture) noexcept;
+        void attach_depth_texture(size_t framebuffer, size_t texture) noexcept;
 
         void set_clear_color(const math::color& color) noexcept;
+        void set_shading_mode(shading_mode mode) noexcept;
+
+        /**
+         * 1 or MSAA_SAMPLE_COUNT. With multisampling coverage and depth are evaluated per sample, 
+         * while the pixel shader still runs once per pixel, and the samples are averaged by 
+         * swap_buffers. The render target is reallocated, so it is meant to be set between frames.
+        */
+        void set_sample_count(uint32_t count) noexcept;
+        // Xiaolin Wu's lines: the two pixels across the line share its coverage and are blended with what is under them
+        void set_line_antialiasing(bool enabled) noexcept;
+
+        void set_cull_mode(cull_mode mode) noexcept;
+        void set_front_face(winding front_face) noexcept;
+
+        void set_point_lights(const point_light* lights, size_t count) noexcept;
+        void set_ambient_light(const math::color& color) noexcept;
+        void render_lights(const math::vec3f& camera_position) noexcept;
 
     private:
         _render_engine() noexcept;
 
     private:
-        void _resize_z_buffer(uint32_t width, uint32_t height) noexcept;
-        bool _test_and_update_depth(const math::vec3f& pixel) noexcept;
+        void _resize_render_target(uint32_t width, uint32_t height) noexcept;
+        size_t _pixel_index(uint32_t x, uint32_t y) const noexcept;
 
-    private:
-        bool _is_inside_clip_space(const math::vec4f& coord) const noexcept;
-        
-        bool _is_front_face(const math::vec3f& v0, const math::vec3f& v1, const math::vec3f& v2) const noexcept;
-        
-        /**
-         * returns:
-         *  > 0: point is to the right of the edge
-         *    0: point is on the edge
-         *  < 0: point is to the left of the edge
-        */
-        static double _edge(const math::vec2f& v0, const math::vec2f& v1, const math::vec2f& p) noexcept;
+        static uint32_t _pack_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) noexcept;
 
     private:
         struct pipeline_metadata {
-            bool clipped = false;
             bool is_front = false;
-            pipeline_pack_type in_out_data;
+            uint16_t outcode = 0;
+            math::vec4f clip_coord;
             math::vec4f coord;
         };
-        
-        void _render_pixel(const math::vec2f& pixel, const math::color& color) const noexcept;
-
-        void _render_line(const pipeline_metadata& v0, const pipeline_metadata& v1) const noexcept;
-        void _render_line_low(const pipeline_metadata& v0, const pipeline_metadata& v1) const noexcept;
-        void _render_line_high(const pipeline_metadata& v0, const pipeline_metadata& v1) const noexcept;
-
-        void _render_polygon(const pipeline_metadata& v0, const pipeline_metadata& v1, const pipeline_metadata& v2) noexcept;
 
+        void _shade_vertex(const _shader& shader, const void* vertex, const void* instance, pipeline_metadata& metadata, float* varyings, pipeline_pack_type& pack) const noexcept;
+        // shades up to 4 vertices with _shader::vertex_quad, the varyings written SoA are transposed back to a run per vertex
+        void _shade_vertex_quad(const _shader& shader, size_t count, pipeline_metadata* const* metadata, float* const* varyings, vertex_quad_pack_type& pack) const noexcept;
+        void _process_vertices(const _shader& shader, size_t instance_count) noexcept;
+        
+        // the attributes of the instance in the bound instance buffer, nullptr if there is none
+        const void* _instance_data(size_t instance) const noexcept;
+
+        const float* _varyings(const pipeline_metadata& vertex) const noexcept;
+        void _interpolate_varyings(const float* v0, const float* v1, const float* v2, float w0, float w1, float w2, pipeline_pack_type& pack) const noexcept;
+        void _copy_flat_varyings(const float* provoking, pipeline_pack_type& pack) const noexcept;
+        // the smooth varyings of a quad, w0 and w1 hold the weights of its pixels
+        void _interpolate_quad_varyings(const float* v0, const float* v1, const float* v2, __m128 w0, __m128 w1, quad_pack_type& pack) const noexcept;
+        
     private:
-        template <size_t N>
-        struct barycentric_interpolator {
-            static_assert(math::between(N, static_cast<size_t>(2), static_cast<size_t>(4)));
+        /**
+         * Triangles are clipped in homogeneous space against near and far, and against a guard band 
+         * GUARD_BAND_SIZE pixels wide around the viewport for x and y. Whatever crosses only the viewport 
+         * edges is left to the rasterizer, which clamps its bounding box to the viewport. The band also 
+         * keeps raster coords small enough for the 28.4 edge setup.
+        */
+        static constexpr float GUARD_BAND_SIZE = 8192.0f;
+        static constexpr size_t CLIP_PLANE_COUNT = 6;
+        static constexpr size_t MAX_CLIPPED_VERTICES = 3 + CLIP_PLANE_COUNT;
+
+        enum outcode : uint16_t {
+            OUTSIDE_LEFT = 1 << 0,
+            OUTSIDE_RIGHT = 1 << 1,
+            OUTSIDE_BOTTOM = 1 << 2,
+            OUTSIDE_TOP = 1 << 3,
+            // the clip planes, in the order of m_clip_planes
+            OUTSIDE_NEAR = 1 << 4,
+            OUTSIDE_FAR = 1 << 5,
+            OUTSIDE_GUARD_BAND_LEFT = 1 << 6,
+            OUTSIDE_GUARD_BAND_RIGHT = 1 << 7,
+            OUTSIDE_GUARD_BAND_BOTTOM = 1 << 8,
+            OUTSIDE_GUARD_BAND_TOP = 1 << 9,
+
+            VIEW_VOLUME_OUTCODES = OUTSIDE_LEFT | OUTSIDE_RIGHT | OUTSIDE_BOTTOM | OUTSIDE_TOP | OUTSIDE_NEAR | OUTSIDE_FAR,
+            CLIP_PLANE_OUTCODES = OUTSIDE_NEAR | OUTSIDE_FAR | OUTSIDE_GUARD_BAND_LEFT | OUTSIDE_GUARD_BAND_RIGHT | OUTSIDE_GUARD_BAND_BOTTOM | OUTSIDE_GUARD_BAND_TOP,
         };
 
-        template<>
-        struct barycentric_interpolator<3> {
-            barycentric_interpolator(const math::vec3d& w, const pipeline_data_type& v0, const pipeline_data_type& v1) 
-                : w(w), v0(v0), v1(v1) {}
-
-            pipeline_data_type operator()(const math::vec2f& v2) const noexcept {
-                ASSERT(std::holds_alternative<math::vec2f>(v0), "render engine error", "type of v0 is not \'vec2f\'");
-                ASSERT(std::holds_alternative<math::vec2f>(v1), "render engine error", "type of v1 is not \'vec2f\'");
-
-                return std::get<math::vec2f>(v0) * w.x + std::get<math::vec2f>(v1) * w.y + v2 * w.z;
-            }
-
-            pipeline_data_type operator()(const math::vec3f& v2) const noexcept {
-                ASSERT(std::holds_alternative<math::vec3f>(v0), "render engine error", "type of v0 is not \'vec3f\'");
-                ASSERT(std::holds_alternative<math::vec3f>(v1), "render engine error", "type of v1 is not \'vec3f\'");
+        void _update_clip_planes() noexcept;
+        uint16_t _compute_outcode(const math::vec4f& clip_coord) const noexcept;
+        // whether the bounds of the bound vertex buffer are outside a plane of the view volume, as seen through 'shader'
+        bool _is_out_of_sight(const _shader& shader) const noexcept;
 
-                return std::get<math::vec3f>(v0) * w.x + std::get<math::vec3f>(v1) * w.y + v2 * w.z;
-            }
-
-            pipeline_data_type operator()(const math::vec4f& v2) const noexcept {
-                ASSERT(std::holds_alternative<math::vec4f>(v0), "render engine error", "type of v0 is not \'vec4f\'");
-                ASSERT(std::holds_alternative<math::vec4f>(v1), "render engine error", "type of v1 is not \'vec4f\'");
+    private:
+        void _render_pixel(const math::vec2f& pixel, const math::color& color) noexcept;
 
-                return std::get<math::vec4f>(v0) * w.x + std::get<math::vec4f>(v1) * w.y + v2 * w.z;
-            }
+    private:
+        /**
+         * Sort-middle binning: triangles are sorted into screen tiles first, then every worker 
+         * takes whole tiles, so a tile's depth and color are touched by exactly one thread.
+        */
+        static constexpr uint32_t TILE_SIZE = 64;
+        static constexpr uint32_t TILE_PIXEL_COUNT = TILE_SIZE * TILE_SIZE;
 
-            pipeline_data_type operator()(const math::mat4f& v2) const noexcept {
-                ASSERT(std::holds_alternative<math::mat4f>(v0), "render engine error", "type of v0 is not \'mat4f\'");
-                ASSERT(std::holds_alternative<math::mat4f>(v1), "render engine error", "type of v1 is not \'mat4f\'");
+        /**
+         * Raster coords are snapped to 28.4 fixed point, so edge setup is exact and the same edge 
+         * shared by two triangles never covers a pixel twice (top-left fill rule).
+        */
+        static constexpr int32_t SUBPIXEL_BITS = 4;
+        static constexpr int32_t SUBPIXEL_STEPS = 1 << SUBPIXEL_BITS;
+        static constexpr uint32_t BLOCK_SIZE = 8;
+        static constexpr uint32_t TILE_BLOCKS = TILE_SIZE / BLOCK_SIZE;
+        static constexpr uint32_t TILE_BLOCK_COUNT = TILE_BLOCKS * TILE_BLOCKS;
 
-                return v2;
-            }
+        /**
+         * Coarse depth: the farthest depth of every tile and of every 8x8 block, which lets whole 
+         * triangles and blocks be rejected when their nearest depth is behind it. The margin absorbs 
+         * the rounding difference between the coarse bounds and the per pixel depth.
+        */
+        static constexpr float HIERARCHICAL_Z_EPSILON = 1e-5f;
 
-            math::vec3d w;
-            const pipeline_data_type &v0, &v1;
+        /**
+         * The standard 4x rotated grid, in subpixels relative to the pixel center. Coverage is exact 
+         * per sample, bounds and coarse tests are widened by MSAA_SAMPLE_REACH to account for them.
+        */
+        static constexpr int32_t MSAA_SAMPLE_OFFSETS[MSAA_SAMPLE_COUNT][2] = { { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 } };
+        static constexpr int32_t MSAA_SAMPLE_REACH = 6;
+
+        struct triangle {
+            // indexes into the chunk's vertices, ordered so that the edge functions below are positive inside
+            size_t v0, v1, v2;
+            // the last vertex in primitive order, the source of flat varyings
+            size_t provoking;
+
+            // e(x, y) = a * x + b * y + c for the pixel center of (x, y), e >= 0 means covered. 
+            // edge i is the one opposite to vertex i, so e[i] / area is the barycentric weight of vertex i
+            int64_t a[3], b[3], c[3];
+            int64_t area;
+
+            // inclusive bounds of the pixels with a sample inside the triangle's box, clamped to the viewport and the render target
+            int32_t min_x, min_y, max_x, max_y;
+            float min_z;
+
+            // 1 / clip w of v0, v1, v2 for perspective correct interpolation
+            float inv_w[3];
+            // a[i] / area and b[i] / area: the screen space derivatives of the (not perspective correct) weights
+            float w_dx[3], w_dy[3];
         };
 
-        template<>
-        struct barycentric_interpolator<2> {
-            barycentric_interpolator(const math::vec2d& w, const pipeline_data_type& v0) 
-                : w(w), v0(v0) {}
+        /**
+         * Lines step one pixel at a time along their major axis, over the pixels whose centers lie in [v0, v1) on it, 
+         * so the segments of a strip do not share a pixel. The minor coord, the depth and the screen space parameter t 
+         * are affine in the major coord m, e.g. minor = minor_origin + minor_step * m at the pixel center.
+        */
+        struct line {
+            // indexes into the chunk's vertices, v0 is the one with the smaller major coord
+            size_t v0, v1;
+            // the last vertex in primitive order, the source of flat varyings
+            size_t provoking;
+
+            bool is_x_major;
+            // inclusive, clamped to the viewport and the render target
+            int32_t min_major, max_major;
+            float minor_origin, minor_step;
+            float t_origin, t_step;
+            
+            // the depth is z0 + dz * t, and so is 1 / clip w with inv_w[0] and inv_w[1]
+            float z0, dz;
+            float min_z;
+            float inv_w[2];
+        };
 
-            pipeline_data_type operator()(const math::vec2f& v1) const noexcept {
-                ASSERT(std::holds_alternative<math::vec2f>(v0), "render engine error", "type of v0 is not \'vec2f\'");
+        struct tile {
+            // [x0, x1) x [y0, y1) in raster coords
+            uint32_t x0, y0, x1, y1;
+            // the farthest depth stored in the tile
+            float max_z = math::MATH_INFINITY;
+            // the visibility buffer of the tile holds samples of the current draw waiting to be shaded
+            bool has_visible_samples = false;
+            // the G-buffer of the tile holds samples waiting for render_lights
+            bool has_gbuffer_samples = false;
+
+            // fast clears: a cleared tile's storage is stale, every sample of it is the clear value 
+            // until the tile is first drawn to, see _materialize_tile
+            bool is_depth_cleared = true;
+            bool is_color_cleared = true;
+            uint32_t clear_color = 0;
+        };
 
-                return std::get<math::vec2f>(v0) * w.x + v1 * w.y;
-            }
+        // the triangle visible at a sample and the barycentric weights of its first two vertices at the pixel center
+        struct visibility_sample {
+            uint32_t chunk = INVALID_CHUNK;
+            uint32_t triangle = 0;
+            float w0 = 0.0f, w1 = 0.0f;
+        };
 
-            pipeline_data_type operator()(const math::vec3f& v1) const noexcept {
-                ASSERT(std::holds_alternative<math::vec3f>(v0), "render engine error", "type of v0 is not \'vec3f\'");
+        static constexpr uint32_t INVALID_CHUNK = UINT32_MAX;
 
-                return std::get<math::vec3f>(v0) * w.x + v1 * w.y;
-            }
+        /**
+         * The front end runs on chunks of PRIMITIVE_CHUNK_SIZE triangles or lines of the index buffer, one worker each. 
+         * A chunk shades only the vertices its indexes reference, through a direct-mapped post-transform cache, 
+         * then clips, culls, sets up and bins its primitives into its own tile lists, so chunks share nothing 
+         * writable. Tiles walk the chunks in order, which keeps the primitive order. Instances are laid out 
+         * one after another in the same sequence of primitives, so the whole draw is one pass.
+        */
+        static constexpr size_t PRIMITIVE_CHUNK_SIZE = 2048;
+        static constexpr size_t VERTEX_CACHE_SIZE = 1024;
+        static constexpr size_t VERTEX_BATCH_SIZE = 4096;
+        // vertices with an attribute layout are fetched in runs this long, one attribute of the whole run after another
+        static constexpr size_t ATTRIBUTE_BATCH_SIZE = 64;
+        // the vertices a chunk misses in its cache wait to be fetched and shaded this many at a time, a vertex_quad() each
+        static constexpr size_t PENDING_VERTEX_COUNT = 4;
+
+        struct primitive_chunk {
+            // shaded vertices of the chunk, followed by the ones made by clipping
+            std::vector<pipeline_metadata> vertices;
+            std::vector<float> varyings;
+            // one of them is used, depending on the render mode
+            std::vector<triangle> triangles;
+            std::vector<line> lines;
+
+            // (tile index, primitive index) in primitive order, before being grouped by tile
+            std::vector<std::pair<uint32_t, uint32_t>> bins;
+            // primitives of the i-th tile are tile_primitives[tile_offsets[i], tile_offsets[i + 1])
+            std::vector<uint32_t> tile_offsets;
+            std::vector<uint32_t> tile_primitives;
+        };
 
-            pipeline_data_type operator()(const math::vec4f& v1) const noexcept {
-                ASSERT(std::holds_alternative<math::vec4f>(v0), "render engine error", "type of v0 is not \'vec4f\'");
+        template <typename IndexType>
+        void _process_chunk(const _shader& shader, primitive_chunk& chunk, render_mode mode, size_t first_primitive, size_t last_primitive) noexcept;
+        // shades the chunk's vertices [first_local, first_local + count) from vertex buffer elements 'indices' of 'instances'
+        void _fetch_vertices(const _shader& shader, primitive_chunk& chunk, size_t first_local, const size_t* indices, const size_t* instances, size_t count) const noexcept;
 
-                return std::get<math::vec4f>(v0) * w.x + v1 * w.y;
+        /**
+         * Triangles are assembled CULL_BATCH_SIZE at a time, so that facing is found for the whole batch at once: 
+         * the sign of the determinant of the clip space (x, y, w) of the vertices is the sign of the screen area, 
+         * with no divide and right for the triangles crossing w = 0 too, so culling comes before clipping.
+        */
+        static constexpr size_t CULL_BATCH_SIZE = 8;
+
+        void _assemble_triangles(primitive_chunk& chunk, const size_t (*triangles)[3], size_t count) noexcept;
+        // the bits of the triangles of the batch which are not culled
+        uint32_t _cull_triangles(const primitive_chunk& chunk, const size_t (*triangles)[3], size_t count) const noexcept;
+        void _assemble_triangle(primitive_chunk& chunk, size_t i0, size_t i1, size_t i2) noexcept;
+        size_t _clip_vertex(primitive_chunk& chunk, size_t inside, size_t outside, float t) noexcept;
+        void _emit_triangle(primitive_chunk& chunk, size_t v0, size_t v1, size_t v2, size_t provoking) noexcept;
+
+        bool _setup_triangle(const primitive_chunk& chunk, triangle& tri) const noexcept;
+        void _bin_triangle(primitive_chunk& chunk, size_t triangle_index) const noexcept;
+
+        // clipped in homogeneous space against the same planes as triangles
+        void _assemble_line(primitive_chunk& chunk, size_t i0, size_t i1) noexcept;
+        bool _setup_line(const primitive_chunk& chunk, line& line) const noexcept;
+        void _bin_line(primitive_chunk& chunk, size_t line_index) const noexcept;
+        
+        void _sort_bins(primitive_chunk& chunk) const noexcept;
+
+        void _rasterize_tiles(bool lines) noexcept;
+        void _rasterize_tile(size_t tile_index, bool lines) noexcept;
+        void _resolve_tiles() noexcept;
+
+        template <uint32_t SAMPLE_COUNT>
+        void _render_polygon(uint32_t chunk_index, uint32_t triangle_index, tile& tile) noexcept;
+        // depth tested and shaded forward whatever the shading mode is
+        template <uint32_t SAMPLE_COUNT>
+        void _render_line(uint32_t chunk_index, uint32_t line_index, tile& tile) noexcept;
+        // fills the derivatives of 'pack' for the pixel where the perspective correct weights of tri's v0 and v1 are w0 and w1
+        void _compute_weight_derivatives(const triangle& tri, float w0, float w1, pipeline_pack_type& pack) const noexcept;
+        void _shade_visible_samples(size_t tile_index) noexcept;
+        void _light_tile(size_t tile_index, const math::vec3f& camera_position) noexcept;
+        // writes the clear values into the storage of a cleared tile, to be called before it is drawn to
+        void _materialize_tile(size_t tile_index) noexcept;
+
+        // workers pull the jobs [0, count) one at a time until none are left
+        template <typename Func>
+        void _parallel_for(size_t count, const Func& func) noexcept {
+            m_next_job.store(0);
+
+            for (size_t i = 0; i < m_worker_count; ++i) {
+                m_thread_pool.AddTask([this, count, &func]() {
+                    for (size_t job = m_next_job++; job < count; job = m_next_job++) {
+                        func(job);
+                    }
+                });
             }
 
-            pipeline_data_type operator()(const math::mat4f& v1) const noexcept {
-                ASSERT(std::holds_alternative<math::mat4f>(v0), "render engine error", "type of v0 is not \'mat4f\'");
+            m_thread_pool.WaitAll();
+        }
 
-                return v1;
-            }
+    private:
+        struct render_target {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t tiles_x = 0;
+            uint32_t tiles_y = 0;
+            uint32_t sample_count = 1;
+        };
 
-            math::vec2d w;
-            const pipeline_data_type &v0;
+        /**
+         * Whatever a render target is made of. The bound one lives in the members below and the others wait here, 
+         * they are swapped on bind, so drawing is the same whatever it draws into.
+        */
+        struct framebuffer {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            size_t color_texture = 0;
+            size_t depth_texture = 0;
+
+            std::vector<float> z_buffer;
+            std::vector<float> block_max_z;
+            std::vector<uint32_t> color_buffer;
+            std::vector<visibility_sample> visibility_buffer;
+            std::vector<gbuffer_sample> gbuffer;
+            std::vector<uint8_t> gbuffer_owner;
+            std::vector<uint8_t> gbuffer_mask;
+            std::vector<uint32_t> present_buffer;
+            render_target target;
+            std::vector<tile> tiles;
         };
 
+        void _swap_framebuffer(framebuffer& storage) noexcept;
+        // to the window's size or the bound framebuffer's
+        void _update_render_target() noexcept;
+        void _copy_attachments(const framebuffer& framebuffer) noexcept;
+
     private:
+        // depth and color are stored tile by tile: the pixels of one tile are contiguous. A multisampled 
+        // tile is a sequence of TILE_PIXEL_COUNT sized planes, plane s holds sample s of every pixel
         std::vector<float> m_z_buffer;
+        std::vector<float> m_block_max_z;
+        std::vector<uint32_t> m_color_buffer;
+        std::vector<visibility_sample> m_visibility_buffer;
+        // laid out like the z-buffer. A triangle's surface is stored once per pixel, in the plane m_gbuffer_owner names for each 
+        // of its samples: the one of the first sample still showing it. Bit s of m_gbuffer_mask[i] is set when sample s waits for render_lights
+        std::vector<gbuffer_sample> m_gbuffer;
+        std::vector<uint8_t> m_gbuffer_owner;
+        std::vector<uint8_t> m_gbuffer_mask;
+        std::vector<uint32_t> m_present_buffer;
+        // the window's resolved color, written by resolve_frame into the buffer m_staged_buffer does not name, which it names afterwards
+        std::vector<uint32_t> m_staging_buffers[2];
+        std::atomic<size_t> m_staged_buffer = 0;
+        render_target m_render_target;
+        std::vector<tile> m_tiles;
+        std::atomic<size_t> m_next_job = 0;
+
+        // the whole vertex buffer, shaded for the point mode
         std::vector<pipeline_metadata> m_pipeline_data;
+        // vertex shader outputs, m_varying_layout.components floats per vertex of m_pipeline_data
+        std::vector<float> m_varyings;
+        varying_layout m_varying_layout;
+
+        std::vector<primitive_chunk> m_chunks;
+        size_t m_chunk_count = 0;
 
-        util::ThreadPool m_thread_pool = { std::thread::hardware_concurrency() };
+        const size_t m_worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+        util::ThreadPool m_thread_pool = { m_worker_count };
 
         struct viewport {
             math::mat4f matrix;
@@ -156,7 +500,23 @@ namespace gl {
             int32_t height = 0;
         } m_viewport;
 
+        // near, far and the guard band planes: dot(plane, clip_coord) >= 0 is inside
+        math::vec4f m_clip_planes[CLIP_PLANE_COUNT];
+
+        _slot_map<framebuffer> m_framebuffers;
+        size_t m_binded_framebuffer = 0;
+        // the window's storage while a framebuffer is bound
+        framebuffer m_window_framebuffer;
+
         win_framewrk::Window* m_window_ptr = nullptr;
         math::color m_clear_color = math::color::BLACK;
+        shading_mode m_shading_mode = shading_mode::FORWARD;
+        uint32_t m_sample_count = 1;
+        bool m_line_antialiasing = false;
+        cull_mode m_cull_mode = cull_mode::BACK;
+        winding m_front_face = winding::CCW;
+
+        std::vector<point_light> m_point_lights;
+        math::color m_ambient_light = math::color(0.1f);
     };
 }
\ No newline at end of file
@@ -18,18 +18,86 @@ namespace gl {
         m_render_engine.render(mode);
     }
 
+    void _render_engine_api::render_instanced(render_mode mode, size_t instance_count) const noexcept {
+        m_render_engine.render_instanced(mode, instance_count);
+    }
+
     void _render_engine_api::swap_buffers() const noexcept {
         m_render_engine.swap_buffers();
     }
 
+    void _render_engine_api::resolve_frame() const noexcept {
+        m_render_engine.resolve_frame();
+    }
+
+    void _render_engine_api::present_frame() const noexcept {
+        m_render_engine.present_frame();
+    }
+
     void _render_engine_api::clear_depth_buffer() const noexcept {
         m_render_engine.clear_depth_buffer();
     }
 
+    void _render_engine_api::clear_color_buffer() const noexcept {
+        m_render_engine.clear_color_buffer();
+    }
+
+    size_t _render_engine_api::create_framebuffer(uint32_t width, uint32_t height) const noexcept {
+        return m_render_engine.create_framebuffer(width, height);
+    }
+
+    void _render_engine_api::delete_framebuffer(size_t id) const noexcept {
+        m_render_engine.delete_framebuffer(id);
+    }
+
+    void _render_engine_api::bind_framebuffer(size_t id) const noexcept {
+        m_render_engine.bind_framebuffer(id);
+    }
+
+    void _render_engine_api::attach_color_texture(size_t framebuffer, size_t texture) const noexcept {
+        m_render_engine.attach_color_texture(framebuffer, texture);
+    }
+
+    void _render_engine_api::attach_depth_texture(size_t framebuffer, size_t texture) const noexcept {
+        m_render_engine.attach_depth_texture(framebuffer, texture);
+    }
+
     void _render_engine_api::set_clear_color(const math::color &color) const noexcept {
         m_render_engine.set_clear_color(color);
     }
 
+    void _render_engine_api::set_shading_mode(shading_mode mode) const noexcept {
+        m_render_engine.set_shading_mode(mode);
+    }
+
+    void _render_engine_api::set_sample_count(uint32_t count) const noexcept {
+        m_render_engine.set_sample_count(count);
+    }
+
+    void _render_engine_api::set_line_antialiasing(bool enabled) const noexcept {
+        m_render_engine.set_line_antialiasing(enabled);
+    }
+
+    void _render_engine_api::set_cull_mode(cull_mode mode) const noexcept {
+        m_render_engine.set_cull_mode(mode);
+    }
+
+    void _render_engine_api::set_front_face(winding front_face) const noexcept {
+        m_render_engine.set_front_face(front_face);
+    }
+
+    void _render_engine_api::set_point_lights(const point_light* lights, size_t count) const noexcept {
+        m_render_engine.set_point_lights(lights, count);
+    }
+
+    void _render_engine_api::set_ambient_light(const math::color& color) const noexcept {
+        m_render_engine.set_ambient_light(color);
+    }
+
+    void _render_engine_api::render_lights(const math::vec3f& camera_position) const noexcept {
+        m_render_engine.render_lights(camera_position);
+    }
+
     void _render_engine_api::viewport(uint32_t width, uint32_t height) const noexcept {
         m_render_engine.viewport(width, height);
     }
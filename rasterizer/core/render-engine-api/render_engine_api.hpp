@@ -10,10 +10,29 @@ namespace gl {
         const win_framewrk::Window* is_window_binded() const noexcept;
 
         void render(render_mode mode) const noexcept;
+        void render_instanced(render_mode mode, size_t instance_count) const noexcept;
         void swap_buffers() const noexcept;
+        void resolve_frame() const noexcept;
+        void present_frame() const noexcept;
         void clear_depth_buffer() const noexcept;
+        void clear_color_buffer() const noexcept;
+
+        size_t create_framebuffer(uint32_t width, uint32_t height) const noexcept;
+        void delete_framebuffer(size_t id) const noexcept;
+        void bind_framebuffer(size_t id) const noexcept;
+        void attach_color_texture(size_t framebuffer, size_t texture) const noexcept;
+        void attach_depth_texture(size_t framebuffer, size_t texture) const noexcept;
 
         void set_clear_color(const math::color& color) const noexcept;
+        void set_shading_mode(shading_mode mode) const noexcept;
+        void set_sample_count(uint32_t count) const noexcept;
+        void set_line_antialiasing(bool enabled) const noexcept;
+        void set_cull_mode(cull_mode mode) const noexcept;
+        void set_front_face(winding front_face) const noexcept;
+
+        void set_point_lights(const point_light* lights, size_t count) const noexcept;
+        void set_ambient_light(const math::color& color) const noexcept;
+        void render_lights(const math::vec3f& camera_position) const noexcept;
 
         void viewport(uint32_t width, uint32_t height) const noexcept;
     
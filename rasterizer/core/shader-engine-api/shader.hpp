@@ -10,8 +10,58 @@ namespace gl {
         virtual ~_shader() = default;
 
         virtual math::vec4f vertex(const void* vertex, pd& _pd) const noexcept = 0;
+        
+        /**
+         * Called instead of the one above while an instance buffer is bound, 
+         * 'instance' points to the element of the instance being drawn.
+        */
+        virtual math::vec4f vertex(const void* vertex, const void* instance, pd& _pd) const noexcept {
+            return this->vertex(vertex, _pd);
+        }
         virtual math::color pixel(const pd& _pd) const noexcept = 0;
 
+        /**
+         * A shader which has vertex_quad() is run 4 vertices at a time, reading their attributes and writing their 
+         * varyings a lane per vertex, while the vertex buffer has an attribute layout and no instance buffer is bound. 
+         * It returns the clip coordinates of the vertices, vertex() is used otherwise.
+        */
+        virtual bool has_vertex_quad() const noexcept {
+            return false;
+        }
+        virtual quad_vec4f vertex_quad(qvd& _qvd) const noexcept {
+            return quad_vec4f();
+        }
+
+        /**
+         * A shader which has pixel_quad() is run a 2x2 quad at a time by the FORWARD shading of triangles, pixel() 
+         * is still used by the other modes and primitives. The pixels of the quad outside the triangle are shaded 
+         * with extrapolated varyings and discarded, so ddx and ddy of any quad value are its differences across the quad.
+        */
+        virtual bool has_pixel_quad() const noexcept {
+            return false;
+        }
+        virtual quad_color pixel_quad(const qpd& _qpd) const noexcept {
+            return quad_color();
+        }
+
+        /**
+         * The matrix vertex() takes the positions of the bound vertex buffer to clip space with, for the whole draw. 
+         * Together with the bounds of the buffer it lets a draw that is out of sight be skipped, false if there is 
+         * no such matrix. Not called while an instance buffer is bound.
+        */
+        virtual bool bounds_transform(math::mat4f& transform) const noexcept {
+            return false;
+        }
+
+        /**
+         * Called instead of pixel() in shading_mode::GBUFFER. The default writes 
+         * an unlit surface of the pixel() color.
+        */
+        virtual void surface(const pd& _pd, gbuffer_sample& sample) const noexcept {
+            sample.albedo = pixel(_pd);
+            sample.normal = math::vec3f(0.0f);
+        }
+
         virtual void geometry() const noexcept { /*TODO*/ }
     };
 }
\ No newline at end of file
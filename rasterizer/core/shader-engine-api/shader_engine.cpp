@@ -1,7 +1,7 @@
 #include "shader_engine.hpp"
 #include "shader.hpp"
 
-#define _ASSERT_SHADER_PROGRAM_ID_VALIDITY(container, id) ASSERT(container.find((id)) != container.cend(), "shader engine error", "invalid shader program ID")
+#define _ASSERT_SHADER_PROGRAM_ID_VALIDITY(container, id) ASSERT(container.contains((id)), "shader engine error", "invalid shader program ID")
 
 namespace gl {
     _shader_engine &_shader_engine::get() noexcept {
@@ -10,12 +10,12 @@ namespace gl {
     }
 
     size_t _shader_engine::create_shader(const std::shared_ptr<_shader> &shader) noexcept {
-        size_t id;
-        do {
-            id = math::random((size_t)0, SIZE_MAX - 1) + 1;
-        } while (m_shader_programs.find(id) != m_shader_programs.cend());
+        const uniform_layout& layout = shader->_get_uniform_layout();
+        const size_t id = m_shader_programs.insert({ layout.locations, layout.uniforms, shader });
 
-        m_shader_programs[id] = { uniforms_pack_type(), shader };
+        if (m_binded_program != nullptr) {
+            m_binded_program = &m_shader_programs.get(m_binded_shader);
+        }
 
         return id;
     }
@@ -23,10 +23,19 @@ namespace gl {
     void _shader_engine::bind_shader(size_t id) noexcept {
         _ASSERT_SHADER_PROGRAM_ID_VALIDITY(m_shader_programs, id);
         m_binded_shader = id;
+        m_binded_program = &m_shader_programs.get(id);
+    }
+
+    size_t _shader_engine::get_uniform_location(const std::string &uniform_tag) const noexcept {
+        ASSERT(m_binded_program != nullptr, "shader engine error", "there is no binded shader program");
+        ASSERT(m_binded_program->uniform_locations.find(uniform_tag) != m_binded_program->uniform_locations.cend(), "shader engine error", 
+            "\"" + uniform_tag + "\" is not declared by the binded shader");
+
+        return m_binded_program->uniform_locations.at(uniform_tag);
     }
 
     const _shader_engine::shader_program &_shader_engine::_get_binded_shader_program() const noexcept {
-        _ASSERT_SHADER_PROGRAM_ID_VALIDITY(m_shader_programs, m_binded_shader);
-        return m_shader_programs.at(m_binded_shader);
+        ASSERT(m_binded_program != nullptr, "shader engine error", "there is no binded shader program");
+        return *m_binded_program;
     }
 }
\ No newline at end of file
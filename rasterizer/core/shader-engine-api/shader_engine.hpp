@@ -1,10 +1,13 @@
 #pragma once
 #include "math_3d/math.hpp"
 #include "core/assert_macro.hpp"
+#include "core/slot_map.hpp"
 
 #include <unordered_map>
 #include <variant>
 #include <memory>
+#include <vector>
+#include <string>
 
 namespace gl {
     class _shader;
@@ -19,48 +22,60 @@ namespace gl {
         size_t create_shader(const std::shared_ptr<_shader>& shader) noexcept;
         void bind_shader(size_t id) noexcept;
 
+        size_t get_uniform_location(const std::string& uniform_tag) const noexcept;
+
         template<typename Uniform>
-        void uniform(const Uniform& uniform, const std::string& uniform_tag) noexcept {
+        void uniform(const Uniform& uniform, size_t location) noexcept {
             #ifdef _DEBUG
-                ASSERT(m_shader_programs.find(m_binded_shader) != m_shader_programs.cend(), "shader engine error", "invalid shader program ID");
-                
-                #define PACK m_shader_programs.at(m_binded_shader).uniforms
-                if (PACK.find(uniform_tag) != PACK.cend()) {
-                    ASSERT(std::holds_alternative<Uniform>(PACK.at(uniform_tag)), "shader engine error", "type redefinition of " + uniform_tag);
-                }
-                #undef PACK
+                ASSERT(m_binded_program != nullptr, "shader engine error", "there is no binded shader program");
+                ASSERT(location < m_binded_program->uniforms.size(), "shader engine error", "invalid uniform location");
+                ASSERT(std::holds_alternative<Uniform>(m_binded_program->uniforms[location]), "shader engine error", 
+                    "uniform at location " + std::to_string(location) + " has different type than " + typeid(Uniform).name());
             #endif
             
-            m_shader_programs.at(m_binded_shader).uniforms[uniform_tag] = uniform;
+            m_binded_program->uniforms[location] = uniform;
+        }
+
+        template<typename Uniform>
+        void uniform(const Uniform& uniform, const std::string& uniform_tag) noexcept {
+            this->uniform(uniform, get_uniform_location(uniform_tag));
         }
 
     public:
         template<typename Uniform>
-        const Uniform& _get_uniform(const std::string& uniform_tag) const noexcept {
+        const Uniform& _get_uniform(size_t location) const noexcept {
             #ifdef _DEBUG
-                ASSERT(m_shader_programs.find(m_binded_shader) != m_shader_programs.cend(), "shader engine error", "invalid shader program ID");
-                
-                #define PACK m_shader_programs.at(m_binded_shader).uniforms
-                ASSERT(PACK.find(uniform_tag) != PACK.cend(), "shader engine error", "invalid uniform tag");
-                ASSERT(std::holds_alternative<Uniform>(PACK.at(uniform_tag)), "shader engine error", 
-                    "\"" + uniform_tag + "\" has different type than " + typeid(Uniform).name());
-                #undef PACK
+                ASSERT(m_binded_program != nullptr, "shader engine error", "there is no binded shader program");
+                ASSERT(location < m_binded_program->uniforms.size(), "shader engine error", "invalid uniform location");
+                ASSERT(std::holds_alternative<Uniform>(m_binded_program->uniforms[location]), "shader engine error", 
+                    "uniform at location " + std::to_string(location) + " has different type than " + typeid(Uniform).name());
             #endif
 
-            const uniform_type& uniform = m_shader_programs.at(m_binded_shader).uniforms.at(uniform_tag);
-            return std::get<Uniform>(uniform);
+            // checked in release too: reading a uniform as another type than it is declared with terminates
+            return std::get<Uniform>(m_binded_program->uniforms[location]);
         }
 
     private:
         _shader_engine() = default;
 
-    private:
+    public:
         using uniform_type = std::variant<bool, int32_t, uint32_t, int64_t, uint64_t, float, double, 
             math::vec2f, math::vec3f, math::vec4f, math::mat4f>;
-        using uniforms_pack_type = std::unordered_map<std::string, uniform_type>;
 
+        /**
+         * Uniforms declared by a shader, like GLSL's layout(location = N) uniform. Values are kept by location,
+         * so shaders read them with a plain index and tags are resolved only when the application sets them.
+        */
+        struct uniform_layout {
+            std::unordered_map<std::string, size_t> locations;
+            // indexed by location, holds the default value of the declared type
+            std::vector<uniform_type> uniforms;
+        };
+
+    private:
         struct shader_program final {
-            uniforms_pack_type uniforms;
+            std::unordered_map<std::string, size_t> uniform_locations;
+            std::vector<uniform_type> uniforms;
             std::shared_ptr<_shader> shader;
         };
         using shader_id = size_t;
@@ -69,7 +84,9 @@ namespace gl {
         const shader_program& _get_binded_shader_program() const noexcept;
 
     private:
-        std::unordered_map<shader_id, shader_program> m_shader_programs;
+        _slot_map<shader_program> m_shader_programs;
         shader_id m_binded_shader = 0;
+        // cached on bind, creating a shader moves the programs, so it is looked up again then
+        shader_program* m_binded_program = nullptr;
     };
 }
\ No newline at end of file
@@ -13,4 +13,8 @@ namespace gl {
     void _shader_engine_api::bind_shader(size_t id) const noexcept {
         m_shader_engine.bind_shader(id);
     }
+
+    size_t _shader_engine_api::get_uniform_location(const std::string &uniform_tag) const noexcept {
+        return m_shader_engine.get_uniform_location(uniform_tag);
+    }
 }
\ No newline at end of file
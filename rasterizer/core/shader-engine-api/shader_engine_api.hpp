@@ -9,10 +9,17 @@ namespace gl {
         size_t create_shader(const std::shared_ptr<_shader>& shader) const noexcept;
         void bind_shader(size_t id) const noexcept;
 
+        size_t get_uniform_location(const std::string& uniform_tag) const noexcept;
+
         template<typename Uniform>
         void uniform(const Uniform& uniform, const std::string& uniform_tag) const noexcept {
             m_shader_engine.uniform(uniform, uniform_tag);
         }
+
+        template<typename Uniform>
+        void uniform(const Uniform& uniform, size_t location) const noexcept {
+            m_shader_engine.uniform(uniform, location);
+        }
     
     private:
         _shader_engine& m_shader_engine;
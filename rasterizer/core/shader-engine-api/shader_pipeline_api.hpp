@@ -1,33 +1,228 @@
 #pragma once
 #include "core/render-engine-api/render_engine.hpp"
+#include "core/buffer-engine-api/buffer_engine.hpp"
+#include "shader_quad_math.hpp"
+
+#include <type_traits>
+#include <typeinfo>
 
 namespace gl {
     class _shader_pipeline_api {
     public:
         _shader_pipeline_api() = default;
 
+        const _render_engine::varying_layout& _get_varying_layout() const noexcept {
+            return m_varying_layout;
+        }
+
     protected:
         using pd = _render_engine::pipeline_pack_type;
-        
-        template<typename InType>
-        const InType& in(const std::string& tag, const pd& _pd) const noexcept {
-            ASSERT(_pd.find(tag) != _pd.cend(), "shader error", "invalid IN variable tag");
-            ASSERT(std::holds_alternative<InType>(_pd.at(tag)), "shader error", "the IN variable \"" + tag + "\" has different type");
+        using qpd = _render_engine::quad_pack_type;
+        using qvd = _render_engine::vertex_quad_pack_type;
+
+        /**
+         * Declares the varying at 'location', is meant to be called from the shader constructor.
+         * mat4f takes 4 locations: [location, location + 3].
+        */
+        template<typename VaryingType>
+        void varying(size_t location, interpolation qualifier = interpolation::SMOOTH) noexcept {
+            static_assert(std::is_same_v<VaryingType, math::vec2f> || std::is_same_v<VaryingType, math::vec3f> ||
+                std::is_same_v<VaryingType, math::vec4f> || std::is_same_v<VaryingType, math::mat4f>, "unsupported varying type");
+
+            const size_t slots = std::is_same_v<VaryingType, math::mat4f> ? 4 : 1;
+            ASSERT(location + slots <= _render_engine::MAX_VARYING_LOCATIONS, "shader error", "varying location is out of range");
+
+            m_varying_layout.varyings[location] = { typeid(VaryingType).hash_code(), slots, qualifier, 0 };
+            _update_varying_offsets();
+        }
+
+        /**
+         * The attribute at 'location' of the vertex being shaded, as set by set_vertex_attribute and converted to float. 
+         * For vertex(), while the bound vertex buffer has an attribute layout.
+        */
+        template<typename AttributeType>
+        AttributeType attribute(size_t location, const pd& _pd) const noexcept {
+            static_assert(std::is_same_v<AttributeType, float> || std::is_same_v<AttributeType, math::vec2f> || 
+                std::is_same_v<AttributeType, math::vec3f> || std::is_same_v<AttributeType, math::vec4f>, "unsupported attribute type");
+
+            ASSERT(_pd.attributes != nullptr, "shader error", "the vertex buffer has no attribute layout");
+            ASSERT(location < _buffer_engine::MAX_VERTEX_ATTRIBUTES, "shader error", "invalid attribute location");
+
+            const math::vec4f value(_pd.attributes[location]);
+            if constexpr (std::is_same_v<AttributeType, float>) {
+                return value.x;
+            } else if constexpr (std::is_same_v<AttributeType, math::vec2f>) {
+                return value.xy;
+            } else if constexpr (std::is_same_v<AttributeType, math::vec3f>) {
+                return value.xyz;
+            } else {
+                return value;
+            }
+        }
+
+        // the attribute at 'location' of the 4 vertices being shaded by vertex_quad()
+        template<typename AttributeType>
+        AttributeType attribute(size_t location, const qvd& _qvd) const noexcept {
+            static_assert(std::is_same_v<AttributeType, quad_float> || std::is_same_v<AttributeType, quad_vec2f> || 
+                std::is_same_v<AttributeType, quad_vec3f> || std::is_same_v<AttributeType, quad_vec4f>, "unsupported attribute type");
             
-            return std::get<InType>(_pd.at(tag));
+            ASSERT(location < _buffer_engine::MAX_VERTEX_ATTRIBUTES, "shader error", "invalid attribute location");
+
+            const __m128* components = _qvd.attributes + location * 4;
+            if constexpr (std::is_same_v<AttributeType, quad_float>) {
+                return quad_float(components[0]);
+            } else if constexpr (std::is_same_v<AttributeType, quad_vec2f>) {
+                return quad_vec2f(quad_float(components[0]), quad_float(components[1]));
+            } else if constexpr (std::is_same_v<AttributeType, quad_vec3f>) {
+                return quad_vec3f(quad_float(components[0]), quad_float(components[1]), quad_float(components[2]));
+            } else {
+                return quad_vec4f(quad_float(components[0]), quad_float(components[1]), quad_float(components[2]), quad_float(components[3]));
+            }
+        }
+
+        template<typename InType>
+        const InType& in(size_t location, const pd& _pd) const noexcept {
+            ASSERT(location < _render_engine::MAX_VARYING_LOCATIONS, "shader error", "invalid IN variable location");
+            ASSERT(m_varying_layout.varyings[location].type_hash == typeid(InType).hash_code(), "shader error",
+                "the IN variable at location " + std::to_string(location) + " is undeclared or has different type");
+
+            return *reinterpret_cast<const InType*>(_pd.data + m_varying_layout.varyings[location].offset);
+        }
+
+        /**
+         * The IN variable at 'location' for the pixels of a quad, see _shader::pixel_quad. Smooth varyings are read 
+         * as quad_vec2f, quad_vec3f or quad_vec4f, flat ones, the same for the whole quad, as their own type.
+        */
+        template<typename InType>
+        InType in(size_t location, const qpd& _qpd) const noexcept {
+            ASSERT(location < _render_engine::MAX_VARYING_LOCATIONS, "shader error", "invalid IN variable location");
+            const auto& varying = m_varying_layout.varyings[location];
+
+            if constexpr (std::is_same_v<InType, quad_vec2f> || std::is_same_v<InType, quad_vec3f> || std::is_same_v<InType, quad_vec4f>) {
+                using VaryingType = std::conditional_t<std::is_same_v<InType, quad_vec2f>, math::vec2f, 
+                    std::conditional_t<std::is_same_v<InType, quad_vec3f>, math::vec3f, math::vec4f>>;
+                
+                ASSERT(varying.type_hash == typeid(VaryingType).hash_code() && varying.qualifier == interpolation::SMOOTH, "shader error",
+                    "the IN variable at location " + std::to_string(location) + " is undeclared, flat or has different type");
+
+                const __m128* components = _qpd.smooth + varying.offset;
+                if constexpr (std::is_same_v<InType, quad_vec2f>) {
+                    return quad_vec2f(quad_float(components[0]), quad_float(components[1]));
+                } else if constexpr (std::is_same_v<InType, quad_vec3f>) {
+                    return quad_vec3f(quad_float(components[0]), quad_float(components[1]), quad_float(components[2]));
+                } else {
+                    return quad_vec4f(quad_float(components[0]), quad_float(components[1]), quad_float(components[2]), quad_float(components[3]));
+                }
+            } else {
+                ASSERT(varying.type_hash == typeid(InType).hash_code() && varying.qualifier == interpolation::FLAT, "shader error",
+                    "the IN variable at location " + std::to_string(location) + " is undeclared, smooth or has different type");
+                
+                return *reinterpret_cast<const InType*>(_qpd.data + varying.offset);
+            }
+        }
+
+        template<typename OutType>
+        void out(const OutType& var, size_t location, pd& _pd) const noexcept {
+            ASSERT(location < _render_engine::MAX_VARYING_LOCATIONS, "shader error", "invalid OUT variable location");
+            ASSERT(m_varying_layout.varyings[location].type_hash == typeid(OutType).hash_code(), "shader error",
+                "the OUT variable at location " + std::to_string(location) + " is undeclared or has different type");
+
+            *reinterpret_cast<OutType*>(_pd.data + m_varying_layout.varyings[location].offset) = var;
         }
 
+        /**
+         * The OUT variable at 'location' of the 4 vertices being shaded by vertex_quad(): quad_vec2f, quad_vec3f and quad_vec4f 
+         * write a lane per vertex, the varying types themselves write the same value to all of them.
+        */
         template<typename OutType>
-        void out(const OutType& var, const std::string& tag, pd& _pd) const noexcept {
-            #ifdef _DEBUG
-                if (_pd.find(tag) != _pd.cend()) {
-                    ASSERT(std::holds_alternative<OutType>(_pd.at(tag)), "shader error", 
-                        "redefinition a variable with the name" + tag + " but different type"
-                    );
+        void out(const OutType& var, size_t location, qvd& _qvd) const noexcept {
+            ASSERT(location < _render_engine::MAX_VARYING_LOCATIONS, "shader error", "invalid OUT variable location");
+            const auto& varying = m_varying_layout.varyings[location];
+            __m128* components = _qvd.data + varying.offset;
+
+            if constexpr (std::is_same_v<OutType, quad_vec2f> || std::is_same_v<OutType, quad_vec3f> || std::is_same_v<OutType, quad_vec4f>) {
+                using VaryingType = std::conditional_t<std::is_same_v<OutType, quad_vec2f>, math::vec2f, 
+                    std::conditional_t<std::is_same_v<OutType, quad_vec3f>, math::vec3f, math::vec4f>>;
+                
+                ASSERT(varying.type_hash == typeid(VaryingType).hash_code(), "shader error",
+                    "the OUT variable at location " + std::to_string(location) + " is undeclared or has different type");
+
+                components[0] = var.x.lanes;
+                components[1] = var.y.lanes;
+                if constexpr (!std::is_same_v<OutType, quad_vec2f>) {
+                    components[2] = var.z.lanes;
+                }
+                if constexpr (std::is_same_v<OutType, quad_vec4f>) {
+                    components[3] = var.w.lanes;
+                }
+            } else {
+                ASSERT(varying.type_hash == typeid(OutType).hash_code(), "shader error",
+                    "the OUT variable at location " + std::to_string(location) + " is undeclared or has different type");
+                
+                const float* values = reinterpret_cast<const float*>(&var);
+                for (size_t i = 0; i < sizeof(OutType) / sizeof(float); ++i) {
+                    components[i] = _mm_set1_ps(values[i]);
+                }
+            }
+        }
+
+        /**
+         * The screen space derivatives of the IN variable at 'location' for the pixel being shaded, 
+         * exact rather than differences over a quad. Zero for flat varyings, points and lines.
+        */
+        template<typename InType>
+        InType ddx(size_t location, const pd& _pd) const noexcept {
+            return _derivative<InType>(location, _pd.dw_dx, _pd);
+        }
+
+        template<typename InType>
+        InType ddy(size_t location, const pd& _pd) const noexcept {
+            return _derivative<InType>(location, _pd.dw_dy, _pd);
+        }
+
+    private:
+        template<typename InType>
+        InType _derivative(size_t location, const float* dw, const pd& _pd) const noexcept {
+            static_assert(std::is_same_v<InType, math::vec2f> || std::is_same_v<InType, math::vec3f> || std::is_same_v<InType, math::vec4f>, 
+                "unsupported derivative type");
+            
+            ASSERT(location < _render_engine::MAX_VARYING_LOCATIONS, "shader error", "invalid IN variable location");
+            ASSERT(m_varying_layout.varyings[location].type_hash == typeid(InType).hash_code(), "shader error",
+                "the IN variable at location " + std::to_string(location) + " is undeclared or has different type");
+
+            const auto& varying = m_varying_layout.varyings[location];
+            if (_pd.vertex_varyings[0] == nullptr || varying.qualifier == interpolation::FLAT) {
+                return InType();
+            }
+
+            const InType& v0 = *reinterpret_cast<const InType*>(_pd.vertex_varyings[0] + varying.offset);
+            const InType& v1 = *reinterpret_cast<const InType*>(_pd.vertex_varyings[1] + varying.offset);
+            const InType& v2 = *reinterpret_cast<const InType*>(_pd.vertex_varyings[2] + varying.offset);
+            
+            // the weight of v2 is 1 - w0 - w1
+            return (v0 - v2) * dw[0] + (v1 - v2) * dw[1];
+        }
+
+        void _update_varying_offsets() noexcept {
+            size_t offset = 0;
+
+            for (const interpolation qualifier : { interpolation::SMOOTH, interpolation::FLAT }) {
+                if (qualifier == interpolation::FLAT) {
+                    m_varying_layout.smooth_components = offset;
                 }
-            #endif
 
-            _pd[tag] = var;
+                for (auto& varying : m_varying_layout.varyings) {
+                    if (varying.slots != 0 && varying.qualifier == qualifier) {
+                        varying.offset = offset;
+                        offset += varying.slots * _render_engine::VARYING_SLOT_COMPONENTS;
+                    }
+                }
+            }
+
+            m_varying_layout.components = offset;
         }
+
+    private:
+        _render_engine::varying_layout m_varying_layout;
     };
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+#include "math_3d/math.hpp"
+
+#include <cmath>
+
+namespace gl {
+    /**
+     * The functions are found through argument dependent lookup, so that they do not hide 
+     * std::min and the like from unqualified calls elsewhere in the namespace gl.
+    */
+    namespace quad_math {
+        /**
+         * A float for every pixel of a 2x2 quad, lane i is the pixel (x + (i & 1), y + (i >> 1)), so the arithmetic of
+         * a quad shader runs on the four pixels at once. Scalars convert implicitly and are the same in all the lanes.
+        */
+        struct quad_float {
+            quad_float() noexcept : lanes(_mm_setzero_ps()) {}
+            quad_float(float value) noexcept : lanes(_mm_set1_ps(value)) {}
+            explicit quad_float(__m128 lanes) noexcept : lanes(lanes) {}
+
+            float operator[](size_t lane) const noexcept {
+                alignas(16) float values[4];
+                _mm_store_ps(values, lanes);
+                return values[lane];
+            }
+
+            __m128 lanes;
+        };
+
+        // the result of a comparison of quad_floats, all bits set in the lanes where it holds
+        struct quad_bool {
+            __m128 lanes;
+        };
+
+        inline quad_float operator-(const quad_float& a) noexcept { return quad_float(_mm_xor_ps(a.lanes, _mm_set1_ps(-0.0f))); }
+        inline quad_float operator+(const quad_float& a, const quad_float& b) noexcept { return quad_float(_mm_add_ps(a.lanes, b.lanes)); }
+        inline quad_float operator-(const quad_float& a, const quad_float& b) noexcept { return quad_float(_mm_sub_ps(a.lanes, b.lanes)); }
+        inline quad_float operator*(const quad_float& a, const quad_float& b) noexcept { return quad_float(_mm_mul_ps(a.lanes, b.lanes)); }
+        inline quad_float operator/(const quad_float& a, const quad_float& b) noexcept { return quad_float(_mm_div_ps(a.lanes, b.lanes)); }
+
+        inline quad_bool operator<(const quad_float& a, const quad_float& b) noexcept { return { _mm_cmplt_ps(a.lanes, b.lanes) }; }
+        inline quad_bool operator<=(const quad_float& a, const quad_float& b) noexcept { return { _mm_cmple_ps(a.lanes, b.lanes) }; }
+        inline quad_bool operator>(const quad_float& a, const quad_float& b) noexcept { return { _mm_cmpgt_ps(a.lanes, b.lanes) }; }
+        inline quad_bool operator>=(const quad_float& a, const quad_float& b) noexcept { return { _mm_cmpge_ps(a.lanes, b.lanes) }; }
+        inline quad_bool operator&(const quad_bool& a, const quad_bool& b) noexcept { return { _mm_and_ps(a.lanes, b.lanes) }; }
+        inline quad_bool operator|(const quad_bool& a, const quad_bool& b) noexcept { return { _mm_or_ps(a.lanes, b.lanes) }; }
+
+        // 'a' in the lanes where 'condition' holds, 'b' in the others
+        inline quad_float select(const quad_bool& condition, const quad_float& a, const quad_float& b) noexcept {
+            return quad_float(_mm_blendv_ps(b.lanes, a.lanes, condition.lanes));
+        }
+
+        inline quad_float min(const quad_float& a, const quad_float& b) noexcept { return quad_float(_mm_min_ps(a.lanes, b.lanes)); }
+        inline quad_float max(const quad_float& a, const quad_float& b) noexcept { return quad_float(_mm_max_ps(a.lanes, b.lanes)); }
+        inline quad_float sqrt(const quad_float& a) noexcept { return quad_float(_mm_sqrt_ps(a.lanes)); }
+
+        // SSE has no pow, the lanes are raised one by one
+        inline quad_float pow(const quad_float& base, float exponent) noexcept {
+            alignas(16) float values[4];
+            _mm_store_ps(values, base.lanes);
+
+            for (float& value : values) {
+                value = std::pow(value, exponent);
+            }
+            return quad_float(_mm_load_ps(values));
+        }
+
+        /**
+         * The differences between the neighbouring pixels of the quad, along x within its rows and along y within
+         * its columns, like GLSL's dFdxFine and dFdyFine. They are defined for any value computed in a quad shader.
+        */
+        inline quad_float ddx(const quad_float& a) noexcept {
+            return quad_float(_mm_sub_ps(_mm_shuffle_ps(a.lanes, a.lanes, _MM_SHUFFLE(3, 3, 1, 1)), _mm_shuffle_ps(a.lanes, a.lanes, _MM_SHUFFLE(2, 2, 0, 0))));
+        }
+
+        inline quad_float ddy(const quad_float& a) noexcept {
+            return quad_float(_mm_sub_ps(_mm_shuffle_ps(a.lanes, a.lanes, _MM_SHUFFLE(3, 2, 3, 2)), _mm_shuffle_ps(a.lanes, a.lanes, _MM_SHUFFLE(1, 0, 1, 0))));
+        }
+
+    #pragma region quad-vectors
+        struct quad_vec2f {
+            quad_vec2f() noexcept = default;
+            quad_vec2f(const quad_float& x, const quad_float& y) noexcept : x(x), y(y) {}
+            quad_vec2f(const math::vec2f& v) noexcept : x(v.x), y(v.y) {}
+
+            math::vec2f operator[](size_t lane) const noexcept { return math::vec2f(x[lane], y[lane]); }
+
+            quad_float x, y;
+        };
+
+        struct quad_vec3f {
+            quad_vec3f() noexcept = default;
+            quad_vec3f(const quad_float& x, const quad_float& y, const quad_float& z) noexcept : x(x), y(y), z(z) {}
+            quad_vec3f(const math::vec3f& v) noexcept : x(v.x), y(v.y), z(v.z) {}
+
+            math::vec3f operator[](size_t lane) const noexcept { return math::vec3f(x[lane], y[lane], z[lane]); }
+
+            quad_float x, y, z;
+        };
+
+        struct quad_vec4f {
+            quad_vec4f() noexcept = default;
+            quad_vec4f(const quad_float& x, const quad_float& y, const quad_float& z, const quad_float& w) noexcept : x(x), y(y), z(z), w(w) {}
+            quad_vec4f(const quad_vec3f& xyz, const quad_float& w) noexcept : x(xyz.x), y(xyz.y), z(xyz.z), w(w) {}
+            quad_vec4f(const math::vec4f& v) noexcept : x(v.x), y(v.y), z(v.z), w(v.w) {}
+
+            quad_vec3f xyz() const noexcept { return quad_vec3f(x, y, z); }
+            math::vec4f operator[](size_t lane) const noexcept { return math::vec4f(x[lane], y[lane], z[lane], w[lane]); }
+
+            quad_float x, y, z, w;
+        };
+
+        using quad_color = quad_vec4f;
+
+        inline quad_vec2f operator+(const quad_vec2f& a, const quad_vec2f& b) noexcept { return quad_vec2f(a.x + b.x, a.y + b.y); }
+        inline quad_vec2f operator-(const quad_vec2f& a, const quad_vec2f& b) noexcept { return quad_vec2f(a.x - b.x, a.y - b.y); }
+        inline quad_vec2f operator*(const quad_vec2f& a, const quad_float& s) noexcept { return quad_vec2f(a.x * s, a.y * s); }
+        inline quad_vec2f operator*(const quad_float& s, const quad_vec2f& a) noexcept { return a * s; }
+        inline quad_vec2f ddx(const quad_vec2f& a) noexcept { return quad_vec2f(ddx(a.x), ddx(a.y)); }
+        inline quad_vec2f ddy(const quad_vec2f& a) noexcept { return quad_vec2f(ddy(a.x), ddy(a.y)); }
+
+        inline quad_vec3f operator-(const quad_vec3f& a) noexcept { return quad_vec3f(-a.x, -a.y, -a.z); }
+        inline quad_vec3f operator+(const quad_vec3f& a, const quad_vec3f& b) noexcept { return quad_vec3f(a.x + b.x, a.y + b.y, a.z + b.z); }
+        inline quad_vec3f operator-(const quad_vec3f& a, const quad_vec3f& b) noexcept { return quad_vec3f(a.x - b.x, a.y - b.y, a.z - b.z); }
+        inline quad_vec3f operator*(const quad_vec3f& a, const quad_float& s) noexcept { return quad_vec3f(a.x * s, a.y * s, a.z * s); }
+        inline quad_vec3f operator*(const quad_float& s, const quad_vec3f& a) noexcept { return a * s; }
+
+        inline quad_float dot(const quad_vec3f& a, const quad_vec3f& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        inline quad_vec3f normalize(const quad_vec3f& a) noexcept {
+            const quad_float length = sqrt(dot(a, a));
+            return quad_vec3f(a.x / length, a.y / length, a.z / length);
+        }
+
+        // see math::reflect
+        inline quad_vec3f reflect(const quad_vec3f& unit_vec, const quad_vec3f& normal) noexcept {
+            return 2.0f * normal * dot(-unit_vec, normal) + unit_vec;
+        }
+
+        inline quad_vec4f operator+(const quad_vec4f& a, const quad_vec4f& b) noexcept { return quad_vec4f(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+        inline quad_vec4f operator-(const quad_vec4f& a, const quad_vec4f& b) noexcept { return quad_vec4f(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+        inline quad_vec4f operator*(const quad_vec4f& a, const quad_vec4f& b) noexcept { return quad_vec4f(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+        inline quad_vec4f operator*(const quad_vec4f& a, const quad_float& s) noexcept { return quad_vec4f(a.x * s, a.y * s, a.z * s, a.w * s); }
+        inline quad_vec4f operator*(const quad_float& s, const quad_vec4f& a) noexcept { return a * s; }
+
+        inline quad_vec4f select(const quad_bool& condition, const quad_vec4f& a, const quad_vec4f& b) noexcept {
+            return quad_vec4f(select(condition, a.x, b.x), select(condition, a.y, b.y), select(condition, a.z, b.z), select(condition, a.w, b.w));
+        }
+
+        // row vectors, like math::vec4f * math::mat4f
+        inline quad_vec4f operator*(const quad_vec4f& v, const math::mat4f& m) noexcept {
+            quad_float columns[4];
+            for (size_t j = 0; j < 4; ++j) {
+                columns[j] = v.x * m[0][j] + v.y * m[1][j] + v.z * m[2][j] + v.w * m[3][j];
+            }
+            return quad_vec4f(columns[0], columns[1], columns[2], columns[3]);
+        }
+    #pragma endregion quad-vectors
+    }
+
+    using quad_math::quad_float;
+    using quad_math::quad_bool;
+    using quad_math::quad_vec2f;
+    using quad_math::quad_vec3f;
+    using quad_math::quad_vec4f;
+    using quad_math::quad_color;
+}
\ No newline at end of file
@@ -3,22 +3,184 @@
 
 #include "core/assert_macro.hpp"
 
+#include <algorithm>
+
 namespace gl {
+    /**
+     * Compressed blocks are decoded whole into a small direct-mapped cache of every thread, keyed by the 
+     * address of the block: filtering reads neighbouring texels, mostly of one block, and so do the pixels next to each other.
+    */
+    static constexpr size_t DECODED_BLOCK_CACHE_SIZE = 64;
+
+    struct _decoded_block {
+        const uint64_t* key = nullptr;
+        uint32_t texels[_texture::BLOCK_SIZE * _texture::BLOCK_SIZE];
+    };
+
+    static thread_local _decoded_block decoded_blocks[DECODED_BLOCK_CACHE_SIZE];
+
+    static uint32_t _fetch_texel(const _texture::level& level, uint32_t x, uint32_t y) noexcept {
+        if (level.pages != nullptr) {
+            const uint32_t* texels = level.pages[x / _texture::PAGE_SIZE + y / _texture::PAGE_SIZE * level.pages_x].texels.load(std::memory_order_acquire);
+            ASSERT(texels != nullptr, "texture sampling error", "the page is not resident");
+            
+            return texels[_texture::blocked_index(x % _texture::PAGE_SIZE, y % _texture::PAGE_SIZE, _texture::PAGE_SIZE / _texture::BLOCK_SIZE)];
+        }
+
+        if (level.format == texture_format::RGBA8) {
+            return level.texels[level.index(x, y)];
+        }
+        ASSERT(level.format != texture_format::DEPTH32F, "texture sampling error", "a depth texture is sampled by texture_shadow");
+
+        const size_t block = level.block_index(x, y);
+        const size_t block_words = level.format == texture_format::BC1 ? 1 : 2;
+        const uint64_t* key = &level.blocks[block * block_words];
+        
+        _decoded_block& entry = decoded_blocks[(reinterpret_cast<uintptr_t>(key) / (block_words * sizeof(uint64_t))) % DECODED_BLOCK_CACHE_SIZE];
+        if (entry.key != key) {
+            level.decode_block(block, entry.texels);
+            entry.key = key;
+        }
+
+        return entry.texels[(x % _texture::BLOCK_SIZE) + (y % _texture::BLOCK_SIZE) * _texture::BLOCK_SIZE];
+    }
+
+    static __m128 _unpack_texel(uint32_t texel) noexcept {
+        return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int32_t>(texel))));
+    }
+
+    struct _bilinear_footprint {
+        uint32_t x0, y0, x1, y1;
+        float tu, tv;
+    };
+
+    // clamp to edge addressing, texel centers are at half integer coords, v goes up while the rows go down
+    static _bilinear_footprint _footprint(const _texture::level& level, const math::vec2f& texcoord) noexcept {
+        const float u = std::clamp(texcoord.x, 0.0f, 1.0f) * level.width - 0.5f, v = (1.0f - std::clamp(texcoord.y, 0.0f, 1.0f)) * level.height - 0.5f;
+        const float floor_u = std::floor(u), floor_v = std::floor(v);
+        
+        const int32_t max_x = static_cast<int32_t>(level.width) - 1, max_y = static_cast<int32_t>(level.height) - 1;
+        return {
+            static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floor_u), 0, max_x)), static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floor_v), 0, max_y)),
+            static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floor_u) + 1, 0, max_x)), static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floor_v) + 1, 0, max_y)),
+            u - floor_u, v - floor_v
+        };
+    }
+
+    /**
+     * The first level from 'level' on with every page under the footprint resident, that is 'level' itself unless the texture is a virtual one. 
+     * The missing pages on the way are requested, the resident ones are marked as used in this frame.
+    */
+    static size_t _resident_level(const _texture& texture, size_t level, const math::vec2f& texcoord) noexcept {
+        static _texture_engine& engine = _texture_engine::get();
+
+        for (; texture.levels[level].pages != nullptr; ++level) {
+            const _texture::level& paged = texture.levels[level];
+            const _bilinear_footprint footprint = _footprint(paged, texcoord);
+
+            const size_t page_x0 = footprint.x0 / _texture::PAGE_SIZE, page_x1 = footprint.x1 / _texture::PAGE_SIZE;
+            const size_t page_y0 = footprint.y0 / _texture::PAGE_SIZE * paged.pages_x, page_y1 = footprint.y1 / _texture::PAGE_SIZE * paged.pages_x;
+            const size_t pages[4] = { page_x0 + page_y0, page_x1 + page_y0, page_x0 + page_y1, page_x1 + page_y1 };
+
+            bool resident = true;
+            for (const size_t index : pages) {
+                _texture::page& page = paged.pages[index];
+
+                if (page.texels.load(std::memory_order_acquire) == nullptr) {
+                    if (!page.requested.exchange(true, std::memory_order_relaxed)) {
+                        engine._request_page(paged, index);
+                    }
+                    resident = false;
+                } else if (!page.used.load(std::memory_order_relaxed)) {
+                    page.used.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            if (resident) {
+                break;
+            }
+        }
+
+        return level;
+    }
+
+    // the result is in [0, 255]
+    static __m128 _sample_bilinear(const _texture::level& level, const math::vec2f& texcoord) noexcept {
+        const auto [x0, y0, x1, y1, u, v] = _footprint(level, texcoord);
+        const __m128 tu = _mm_set1_ps(u), tv = _mm_set1_ps(v);
+
+        const __m128 t00 = _unpack_texel(_fetch_texel(level, x0, y0)), t10 = _unpack_texel(_fetch_texel(level, x1, y0));
+        const __m128 t01 = _unpack_texel(_fetch_texel(level, x0, y1)), t11 = _unpack_texel(_fetch_texel(level, x1, y1));
+
+        const __m128 top = _mm_add_ps(t00, _mm_mul_ps(_mm_sub_ps(t10, t00), tu));
+        const __m128 bottom = _mm_add_ps(t01, _mm_mul_ps(_mm_sub_ps(t11, t01), tu));
+        return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), tv));
+    }
+
     const _texture &_shader_texture_api::sampler_2D(size_t slot) const noexcept {
         static _texture_engine& engine = _texture_engine::get();
         return engine._get_slot(slot);
     }
     
     math::color _shader_texture_api::texture(const _texture &texture, const math::vec2f &texcoord) const noexcept {
-        using namespace math;
-
-        const size_t x = clamp(texcoord.x, 0.0f, 1.0f) * (texture.width - 1), y = (1.0f - clamp(texcoord.y, 0.0f, 1.0f)) * (texture.height - 1);
-        const size_t color_start = (x + y * texture.width) * texture.channel_count;
-        return color {
-            texture.data[color_start + 0] / 255.0f,
-            texture.data[color_start + 1] / 255.0f,
-            texture.data[color_start + 2] / 255.0f,
-            texture.channel_count == 4 ? texture.data[color_start + 3] / 255.0f : 1.0f,
-        };
+        const size_t level = _resident_level(texture, 0, texcoord);
+        return math::color(_mm_mul_ps(_sample_bilinear(texture.levels[level], texcoord), _mm_set1_ps(1.0f / 255.0f)));
+    }
+
+    math::color _shader_texture_api::texture_lod(const _texture &texture, const math::vec2f &texcoord, float lod) const noexcept {
+        const float max_lod = static_cast<float>(texture.levels.size() - 1);
+        
+        // also takes NaN to the base level
+        if (!(lod > 0.0f)) {
+            return this->texture(texture, texcoord);
+        }
+        lod = std::min(lod, max_lod);
+
+        const size_t level = static_cast<size_t>(lod);
+        const size_t resident_level = _resident_level(texture, level, texcoord);
+        
+        // while a level of a virtual texture is being loaded the coarser resident one is sampled alone
+        const __m128 fine = _sample_bilinear(texture.levels[resident_level], texcoord);
+        if (resident_level != level || level + 1 == texture.levels.size() || _resident_level(texture, level + 1, texcoord) != level + 1) {
+            return math::color(_mm_mul_ps(fine, _mm_set1_ps(1.0f / 255.0f)));
+        }
+
+        const __m128 coarse = _sample_bilinear(texture.levels[level + 1], texcoord);
+        const __m128 blended = _mm_add_ps(fine, _mm_mul_ps(_mm_sub_ps(coarse, fine), _mm_set1_ps(lod - level)));
+        return math::color(_mm_mul_ps(blended, _mm_set1_ps(1.0f / 255.0f)));
+    }
+
+    math::color _shader_texture_api::texture_grad(const _texture &texture, const math::vec2f &texcoord, const math::vec2f &ddx, const math::vec2f &ddy) const noexcept {
+        // the footprint of the pixel in base level texels, its longer side picks the level
+        const math::vec2f size(static_cast<float>(texture.width), static_cast<float>(texture.height));
+        return texture_lod(texture, texcoord, std::log2(std::max((ddx * size).length(), (ddy * size).length())));
+    }
+
+    quad_color _shader_texture_api::texture(const _texture &texture, const quad_vec2f &texcoord) const noexcept {
+        const quad_vec2f texcoord_dx = ddx(texcoord), texcoord_dy = ddy(texcoord);
+
+        // the lanes are sampled one by one and transposed into the quad's components
+        __m128 texels[4];
+        for (size_t lane = 0; lane < 4; ++lane) {
+            texels[lane] = texture_grad(texture, texcoord[lane], texcoord_dx[lane], texcoord_dy[lane]).xmm;
+        }
+        _MM_TRANSPOSE4_PS(texels[0], texels[1], texels[2], texels[3]);
+
+        return quad_color(quad_float(texels[0]), quad_float(texels[1]), quad_float(texels[2]), quad_float(texels[3]));
+    }
+
+    float _shader_texture_api::texture_shadow(const _texture &texture, const math::vec2f &texcoord, float depth) const noexcept {
+        const _texture::level& level = texture.levels[0];
+        ASSERT(level.format == texture_format::DEPTH32F, "texture sampling error", "the texture is not a depth one");
+
+        const auto [x0, y0, x1, y1, u, v] = _footprint(level, texcoord);
+        const __m128 stored = _mm_castsi128_ps(_mm_setr_epi32(static_cast<int32_t>(level.texels[level.index(x0, y0)]), static_cast<int32_t>(level.texels[level.index(x1, y0)]), 
+            static_cast<int32_t>(level.texels[level.index(x0, y1)]), static_cast<int32_t>(level.texels[level.index(x1, y1)])));
+        
+        alignas(16) float lit[4];
+        _mm_store_ps(lit, _mm_and_ps(_mm_cmple_ps(_mm_set1_ps(depth), stored), _mm_set1_ps(1.0f)));
+
+        const float top = lit[0] + (lit[1] - lit[0]) * u, bottom = lit[2] + (lit[3] - lit[2]) * u;
+        return top + (bottom - top) * v;
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "math_3d/math.hpp"
+#include "shader_quad_math.hpp"
 
 namespace gl {
     struct _texture;
@@ -10,6 +11,19 @@ namespace gl {
 
     protected:
         const _texture& sampler_2D(size_t slot) const noexcept;
+
+        // bilinear, from the base level or, for a virtual texture, from the finest level resident there
         math::color texture(const _texture& texture, const math::vec2f& texcoord) const noexcept;
+        // trilinear, between the two levels around 'lod', clamped to the mip chain
+        math::color texture_lod(const _texture& texture, const math::vec2f& texcoord, float lod) const noexcept;
+        // trilinear, the level of detail is given by the screen space derivatives of 'texcoord', see ddx and ddy
+        math::color texture_grad(const _texture& texture, const math::vec2f& texcoord, const math::vec2f& ddx, const math::vec2f& ddy) const noexcept;
+        // trilinear for the pixels of a quad, the level of detail is given by the differences of 'texcoord' across it
+        quad_color texture(const _texture& texture, const quad_vec2f& texcoord) const noexcept;
+        /**
+         * As GLSL's sampler2DShadow, for DEPTH32F textures: 'depth' is compared against each texel of the bilinear footprint 
+         * and the results are filtered, 1 when it is nowhere farther than the stored depth.
+        */
+        float texture_shadow(const _texture& texture, const math::vec2f& texcoord, float depth) const noexcept;
     };
 }
\ No newline at end of file
@@ -7,12 +7,34 @@ namespace gl {
     class _shader_uniform_api {
     public:
         _shader_uniform_api() = default;
+
+        const _shader_engine::uniform_layout& _get_uniform_layout() const noexcept {
+            return m_uniform_layout;
+        }
     
     protected:
+        /**
+         * Declares the uniform 'tag' at 'location', is meant to be called from the shader constructor.
+        */
         template <typename Uniform>
-        const Uniform& get_uniform(const std::string& tag) const noexcept {
+        void uniform(size_t location, const std::string& tag) noexcept {
+            ASSERT(m_uniform_layout.locations.find(tag) == m_uniform_layout.locations.cend(), "shader error", "redeclaration of uniform " + tag);
+
+            if (location >= m_uniform_layout.uniforms.size()) {
+                m_uniform_layout.uniforms.resize(location + 1);
+            }
+            
+            m_uniform_layout.uniforms[location] = Uniform();
+            m_uniform_layout.locations[tag] = location;
+        }
+
+        template <typename Uniform>
+        const Uniform& get_uniform(size_t location) const noexcept {
             static _shader_engine& engine = _shader_engine::get();
-            return engine._get_uniform<Uniform>(tag);
+            return engine._get_uniform<Uniform>(location);
         }
+
+    private:
+        _shader_engine::uniform_layout m_uniform_layout;
     };
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+#include "core/assert_macro.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace gl {
+    /**
+     * The resources of an engine. Values are kept dense, in no particular order, and are found through a table 
+     * of slots: a handle is the slot number plus one in its low 32 bits and the slot's generation in the high ones. 
+     * The generation is odd while the slot is in use and changes when it is freed, so a stale handle never reaches 
+     * the value that reuses the slot. 0 is never a handle. Values move on insert and erase, references to them 
+     * are good until the next one.
+    */
+    template <typename T>
+    class _slot_map final {
+    public:
+        _slot_map() = default;
+
+        size_t insert(T&& value) noexcept {
+            uint32_t slot_number = m_free_slot;
+            if (slot_number == NO_SLOT) {
+                slot_number = static_cast<uint32_t>(m_slots.size());
+                m_slots.emplace_back();
+            } else {
+                m_free_slot = m_slots[slot_number].index;
+            }
+
+            slot& slot = m_slots[slot_number];
+            slot.generation++;
+            slot.index = static_cast<uint32_t>(m_values.size());
+
+            m_values.emplace_back(std::move(value));
+            m_value_slots.push_back(slot_number);
+
+            return (static_cast<size_t>(slot.generation) << 32) | (slot_number + 1);
+        }
+
+        // the last value is moved into the place of the erased one
+        void erase(size_t handle) noexcept {
+            if (!contains(handle)) {
+                return;
+            }
+
+            const uint32_t slot_number = _slot_number(handle);
+            const uint32_t index = m_slots[slot_number].index;
+
+            if (index + 1 != m_values.size()) {
+                m_values[index] = std::move(m_values.back());
+                m_value_slots[index] = m_value_slots.back();
+                m_slots[m_value_slots[index]].index = index;
+            }
+            m_values.pop_back();
+            m_value_slots.pop_back();
+
+            m_slots[slot_number].generation++;
+            m_slots[slot_number].index = m_free_slot;
+            m_free_slot = slot_number;
+        }
+
+        bool contains(size_t handle) const noexcept {
+            const uint32_t slot_number = _slot_number(handle);
+            const uint32_t generation = static_cast<uint32_t>(handle >> 32);
+
+            return slot_number < m_slots.size() && m_slots[slot_number].generation == generation && (generation & 1) != 0;
+        }
+
+        T& get(size_t handle) noexcept {
+            ASSERT(contains(handle), "slot map error", "invalid handle");
+            return m_values[m_slots[_slot_number(handle)].index];
+        }
+
+        const T& get(size_t handle) const noexcept {
+            ASSERT(contains(handle), "slot map error", "invalid handle");
+            return m_values[m_slots[_slot_number(handle)].index];
+        }
+
+        size_t size() const noexcept { return m_values.size(); }
+
+        typename std::vector<T>::iterator begin() noexcept { return m_values.begin(); }
+        typename std::vector<T>::iterator end() noexcept { return m_values.end(); }
+        typename std::vector<T>::const_iterator begin() const noexcept { return m_values.cbegin(); }
+        typename std::vector<T>::const_iterator end() const noexcept { return m_values.cend(); }
+
+    private:
+        static uint32_t _slot_number(size_t handle) noexcept {
+            return static_cast<uint32_t>(handle) - 1;
+        }
+
+    private:
+        static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+        struct slot {
+            uint32_t generation = 0;
+            // of the value while the slot is in use, of the next free slot otherwise
+            uint32_t index = NO_SLOT;
+        };
+
+        std::vector<slot> m_slots;
+        std::vector<T> m_values;
+        // the slot of every value
+        std::vector<uint32_t> m_value_slots;
+        uint32_t m_free_slot = NO_SLOT;
+    };
+}
\ No newline at end of file
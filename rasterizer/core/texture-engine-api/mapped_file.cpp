@@ -0,0 +1,101 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace gl {
+    _mapped_file::~_mapped_file() {
+        close();
+    }
+
+    bool _mapped_file::open(const char* filename) noexcept {
+        close();
+
+    #ifdef _WIN32
+        m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping == nullptr) {
+            close();
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_size = static_cast<size_t>(size.QuadPart);
+    #else
+        const int file = ::open(filename, O_RDONLY);
+        if (file < 0) {
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size == 0) {
+            ::close(file);
+            return false;
+        }
+
+        // the mapping keeps its own reference to the file
+        void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+
+        m_data = data != MAP_FAILED ? static_cast<const uint8_t*>(data) : nullptr;
+        m_size = static_cast<size_t>(status.st_size);
+    #endif
+
+        if (m_data == nullptr) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void _mapped_file::close() noexcept {
+    #ifdef _WIN32
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != nullptr) {
+            CloseHandle(m_file);
+        }
+
+        m_file = nullptr;
+        m_mapping = nullptr;
+    #else
+        if (m_data != nullptr) {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+    #endif
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const uint8_t* _mapped_file::data() const noexcept {
+        return m_data;
+    }
+
+    size_t _mapped_file::size() const noexcept {
+        return m_size;
+    }
+}
\ No newline at end of file
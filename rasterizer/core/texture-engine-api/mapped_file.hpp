@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace gl {
+    // a read-only view of a whole file, the OS pages it in on access and may drop it under memory pressure
+    class _mapped_file final {
+    public:
+        _mapped_file() = default;
+        ~_mapped_file();
+
+        _mapped_file(const _mapped_file& file) = delete;
+        _mapped_file& operator=(const _mapped_file& file) = delete;
+
+        bool open(const char* filename) noexcept;
+        void close() noexcept;
+
+        const uint8_t* data() const noexcept;
+        size_t size() const noexcept;
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+
+    #ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+    #endif
+    };
+}
\ No newline at end of file
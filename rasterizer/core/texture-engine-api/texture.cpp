@@ -1,8 +1,230 @@
 #include "texture.hpp"
 
+#include <algorithm>
+
 namespace gl {
+    #pragma region block-compression
+    static uint32_t _channel(uint32_t texel, uint32_t channel) noexcept {
+        return (texel >> (channel * 8)) & 0xFF;
+    }
+
+    static uint16_t _pack_565(uint32_t texel) noexcept {
+        return static_cast<uint16_t>(((_channel(texel, 0) * 31 + 127) / 255) << 11 | ((_channel(texel, 1) * 63 + 127) / 255) << 5 | ((_channel(texel, 2) * 31 + 127) / 255));
+    }
+
+    static uint32_t _unpack_565(uint16_t color) noexcept {
+        const uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+        return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16) | 0xFF000000;
+    }
+
+    // (a * weight_a + b * weight_b) / divisor, channel by channel
+    static uint32_t _blend(uint32_t a, uint32_t b, uint32_t weight_a, uint32_t weight_b, uint32_t divisor) noexcept {
+        uint32_t result = 0;
+        for (uint32_t channel = 0; channel < 4; ++channel) {
+            result |= ((_channel(a, channel) * weight_a + _channel(b, channel) * weight_b) / divisor) << (channel * 8);
+        }
+        return result;
+    }
+
+    static void _color_palette(uint16_t color0, uint16_t color1, bool four_colors, uint32_t* palette) noexcept {
+        palette[0] = _unpack_565(color0);
+        palette[1] = _unpack_565(color1);
+
+        if (four_colors) {
+            palette[2] = _blend(palette[0], palette[1], 2, 1, 3);
+            palette[3] = _blend(palette[0], palette[1], 1, 2, 3);
+        } else {
+            palette[2] = _blend(palette[0], palette[1], 1, 1, 2);
+            palette[3] = 0;
+        }
+    }
+
+    static void _alpha_palette(uint32_t alpha0, uint32_t alpha1, uint32_t* palette) noexcept {
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+
+        if (alpha0 > alpha1) {
+            for (uint32_t i = 1; i < 7; ++i) {
+                palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+            }
+        } else {
+            for (uint32_t i = 1; i < 5; ++i) {
+                palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    /**
+     * The endpoints are opposite corners of the block's bounding box in RGB: the diagonal along which 
+     * the channels change together, judged against the channel with the widest range.
+    */
+    static uint64_t _encode_color_block(const uint32_t* texels) noexcept {
+        int32_t min_value[3], max_value[3], mean[3];
+        for (uint32_t channel = 0; channel < 3; ++channel) {
+            min_value[channel] = 255;
+            max_value[channel] = 0;
+            mean[channel] = 0;
+
+            for (uint32_t i = 0; i < 16; ++i) {
+                const int32_t value = _channel(texels[i], channel);
+                
+                min_value[channel] = std::min(min_value[channel], value);
+                max_value[channel] = std::max(max_value[channel], value);
+                mean[channel] += value;
+            }
+            mean[channel] /= 16;
+        }
+
+        uint32_t widest = 0;
+        for (uint32_t channel = 1; channel < 3; ++channel) {
+            widest = max_value[channel] - min_value[channel] > max_value[widest] - min_value[widest] ? channel : widest;
+        }
+
+        uint32_t max_texel = 0xFF000000, min_texel = 0xFF000000;
+        for (uint32_t channel = 0; channel < 3; ++channel) {
+            int32_t covariance = 0;
+            for (uint32_t i = 0; i < 16; ++i) {
+                covariance += (static_cast<int32_t>(_channel(texels[i], widest)) - mean[widest]) * (static_cast<int32_t>(_channel(texels[i], channel)) - mean[channel]);
+            }
+
+            const bool flipped = covariance < 0;
+            max_texel |= static_cast<uint32_t>(flipped ? min_value[channel] : max_value[channel]) << (channel * 8);
+            min_texel |= static_cast<uint32_t>(flipped ? max_value[channel] : min_value[channel]) << (channel * 8);
+        }
+
+        uint16_t color0 = _pack_565(max_texel), color1 = _pack_565(min_texel);
+        if (color0 == color1) {
+            return color0 | (static_cast<uint64_t>(color1) << 16);
+        }
+        
+        // color0 > color1 selects the 4 color mode, the order of the endpoints does not matter otherwise
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        uint32_t palette[4];
+        _color_palette(color0, color1, true, palette);
+
+        uint64_t indices = 0;
+        for (uint32_t i = 0; i < 16; ++i) {
+            uint32_t best = 0, best_distance = UINT32_MAX;
+
+            for (uint32_t k = 0; k < 4; ++k) {
+                uint32_t distance = 0;
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    const int32_t d = static_cast<int32_t>(_channel(texels[i], channel)) - static_cast<int32_t>(_channel(palette[k], channel));
+                    distance += d * d;
+                }
+
+                if (distance < best_distance) {
+                    best = k;
+                    best_distance = distance;
+                }
+            }
+
+            indices |= static_cast<uint64_t>(best) << (2 * i);
+        }
+
+        return color0 | (static_cast<uint64_t>(color1) << 16) | (indices << 32);
+    }
+
+    // alpha0 > alpha1, the 8 value mode
+    static uint64_t _encode_alpha_block(const uint32_t* texels) noexcept {
+        uint32_t alpha0 = 0, alpha1 = 255;
+        for (uint32_t i = 0; i < 16; ++i) {
+            alpha0 = std::max(alpha0, _channel(texels[i], 3));
+            alpha1 = std::min(alpha1, _channel(texels[i], 3));
+        }
+
+        if (alpha0 == alpha1) {
+            return alpha0 | (alpha1 << 8);
+        }
+
+        uint64_t indices = 0;
+        for (uint32_t i = 0; i < 16; ++i) {
+            // the palette steps evenly from alpha0 (step 0) to alpha1 (step 7), index 0 and 1 are the ends
+            const uint32_t step = ((alpha0 - _channel(texels[i], 3)) * 7 + (alpha0 - alpha1) / 2) / (alpha0 - alpha1);
+            const uint32_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            
+            indices |= static_cast<uint64_t>(index) << (3 * i);
+        }
+
+        return alpha0 | (alpha1 << 8) | (indices << 16);
+    }
+    #pragma endregion block-compression
+
     _texture::_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void* data)
-        : data((const uint8_t*)data, (const uint8_t*)data + width * height * channel_count), width(width), height(height), channel_count(channel_count)
+        : width(width), height(height), channel_count(channel_count)
     {
+        levels.emplace_back(width, height);
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x, src += channel_count) {
+                const uint32_t alpha = channel_count == 4 ? src[3] : 255;
+                levels[0].texels[levels[0].index(x, y)] = static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) | (static_cast<uint32_t>(src[2]) << 16) | (alpha << 24);
+            }
+        }
+    }
+
+    _texture::level::level(uint32_t width, uint32_t height)
+        : width(width), height(height), blocks_x((width + BLOCK_SIZE - 1) / BLOCK_SIZE)
+    {
+        texels.resize(blocks_x * ((height + BLOCK_SIZE - 1) / BLOCK_SIZE) * BLOCK_SIZE * BLOCK_SIZE);
+    }
+
+    size_t _texture::blocked_index(uint32_t x, uint32_t y, uint32_t blocks_x) noexcept {
+        return (x / BLOCK_SIZE + y / BLOCK_SIZE * blocks_x) * BLOCK_SIZE * BLOCK_SIZE + ((x & 1) | ((y & 1) << 1) | ((x & 2) << 1) | ((y & 2) << 2));
+    }
+
+    size_t _texture::level::index(uint32_t x, uint32_t y) const noexcept {
+        return blocked_index(x, y, blocks_x);
+    }
+
+    size_t _texture::level::block_index(uint32_t x, uint32_t y) const noexcept {
+        return x / BLOCK_SIZE + y / BLOCK_SIZE * blocks_x;
+    }
+
+    void _texture::level::encode_block(texture_format format, size_t block) noexcept {
+        const uint32_t x0 = block % blocks_x * BLOCK_SIZE, y0 = block / blocks_x * BLOCK_SIZE;
+
+        // the padding of blocks hanging over the level's edge repeats the edge texels
+        uint32_t block_texels[BLOCK_SIZE * BLOCK_SIZE];
+        for (uint32_t i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i) {
+            block_texels[i] = texels[index(std::min(x0 + i % BLOCK_SIZE, width - 1), std::min(y0 + i / BLOCK_SIZE, height - 1))];
+        }
+
+        if (format == texture_format::BC1) {
+            blocks[block] = _encode_color_block(block_texels);
+        } else {
+            blocks[2 * block] = _encode_alpha_block(block_texels);
+            blocks[2 * block + 1] = _encode_color_block(block_texels);
+        }
+    }
+
+    void _texture::level::decode_block(size_t block, uint32_t* texels) const noexcept {
+        const uint64_t color_block = format == texture_format::BC1 ? blocks[block] : blocks[2 * block + 1];
+        const uint16_t color0 = static_cast<uint16_t>(color_block), color1 = static_cast<uint16_t>(color_block >> 16);
+
+        // BC3 color blocks are always in the 4 color mode
+        uint32_t colors[4];
+        _color_palette(color0, color1, format == texture_format::BC3 || color0 > color1, colors);
+
+        for (uint32_t i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i) {
+            texels[i] = colors[(color_block >> (32 + 2 * i)) & 3];
+        }
+
+        if (format == texture_format::BC3) {
+            const uint64_t alpha_block = blocks[2 * block];
+            
+            uint32_t alphas[8];
+            _alpha_palette(alpha_block & 0xFF, (alpha_block >> 8) & 0xFF, alphas);
+
+            for (uint32_t i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i) {
+                texels[i] = (texels[i] & 0x00FFFFFF) | (alphas[(alpha_block >> (16 + 3 * i)) & 7] << 24);
+            }
+        }
     }
 }
\ No newline at end of file
@@ -1,13 +1,81 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <atomic>
 #include <cstdint>
 
 namespace gl {
+    /**
+     * RGBA8 is 4 bytes per texel. BC1 and BC3 are the DXT1 and DXT5 block formats, 8 and 16 bytes 
+     * per 4x4 block: BC1 has 1 bit alpha at best and is compressed as opaque, BC3 keeps 8 bit alpha. Both 
+     * store colors as 565 endpoints and 4 colors per block, which is too coarse for normal maps. 
+     * DEPTH32F texels hold the bits of a float depth, they are rendered to and sampled by texture_shadow only.
+    */
+    enum class texture_format : uint8_t { RGBA8, BC1, BC3, DEPTH32F };
+
     struct _texture {
         _texture() = default;
         _texture(uint32_t width, uint32_t height, uint8_t channel_count, const void* data);
 
-        std::vector<uint8_t> data;
+        /**
+         * Texels are RGBA8 whatever the source channel count is, stored in 4x4 blocks, one cache line 
+         * each: blocks go row by row, the texels of a block go in Morton order. Neighbouring texels of 
+         * both axes are close in memory, which is what filtering and minification read.
+        */
+        static constexpr uint32_t BLOCK_SIZE = 4;
+
+        /**
+         * Virtual textures keep the levels larger than a page as PAGE_SIZE x PAGE_SIZE RGBA8 pages, which are 
+         * loaded on demand from a page file and evicted when unused, see _texture_engine::create_virtual_texture. 
+         * The texels of a page are blocked the same way as the texels of a whole level.
+        */
+        static constexpr uint32_t PAGE_SIZE = 128;
+
+        struct page {
+            // nullptr until the page is resident
+            std::atomic<const uint32_t*> texels { nullptr };
+            // set by the sampler, a missing page is requested from the loader once
+            std::atomic<bool> requested { false };
+            std::atomic<bool> used { false };
+            uint32_t last_used = 0;
+        };
+
+        // of the texel (x, y) in blocked texels of a row 'blocks_x' blocks wide
+        static size_t blocked_index(uint32_t x, uint32_t y, uint32_t blocks_x) noexcept;
+
+        struct level {
+            level() = default;
+            level(uint32_t width, uint32_t height);
+
+            // of the texel (x, y) in 'texels'
+            size_t index(uint32_t x, uint32_t y) const noexcept;
+            
+            // the number of the 4x4 block holding the texel (x, y), blocks go row by row in both layouts
+            size_t block_index(uint32_t x, uint32_t y) const noexcept;
+
+            // compresses a block of 'texels' into 'blocks', which is already sized for 'format'
+            void encode_block(texture_format format, size_t block) noexcept;
+            // the 16 texels of a block of 'blocks', row by row, packed as in 'texels'
+            void decode_block(size_t block, uint32_t* texels) const noexcept;
+
+            texture_format format = texture_format::RGBA8;
+            // RGBA8 texels, empty once compressed
+            std::vector<uint32_t> texels;
+            // BC1 blocks take one word each, BC3 blocks two: the alpha block first, the color block second
+            std::vector<uint64_t> blocks;
+
+            // the pages of a paged level go row by row, 'page_data' is the first of them in the page file
+            std::unique_ptr<page[]> pages;
+            const uint8_t* page_data = nullptr;
+            uint32_t pages_x = 0;
+            
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t blocks_x = 0;
+        };
+
+        // levels[0] is the image itself, every next one is half the previous one, down to 1x1
+        std::vector<level> levels;
         uint32_t width;
         uint32_t height;
         uint8_t channel_count;
@@ -1,26 +1,362 @@
 #include "texture_engine.hpp"
 
-#include "math_3d/util.hpp"
 #include "core/assert_macro.hpp"
 
-#define _ASSERT_TEXTURE_ID_VALIDITY(container, id) ASSERT(container.find((id)) != container.cend(), "texture engine error", "invalid texture ID")
-#define _ASSERT_TEXTURE_SLOT_VALIDITY(container, slot) ASSERT(container.find((slot)) != container.cend(), "texture engine error", "invalid texture slot number")
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+#define _ASSERT_TEXTURE_ID_VALIDITY(container, id) ASSERT(container.contains((id)), "texture engine error", "invalid texture ID")
+#define _ASSERT_TEXTURE_SLOT_VALIDITY(container, slot) ASSERT((slot) < container.size(), "texture engine error", "invalid texture slot number")
 
 namespace gl {
+    /**
+     * A page file is the header followed by the levels, finest first. A level larger than a page in any dimension 
+     * is stored as its pages, row by row, the pages hanging over the level's edge repeat the edge texels. 
+     * The rest of the levels are stored as their 'texels'.
+    */
+    struct _page_file_header {
+        uint32_t magic;
+        uint32_t width;
+        uint32_t height;
+        uint32_t channel_count;
+        uint32_t level_count;
+        // of the image the file was baked from, the file is stale once it differs
+        uint64_t source_fingerprint;
+    };
+
+    static constexpr uint32_t PAGE_FILE_MAGIC = 0x32545650; // "PVT2"
+    static constexpr size_t PAGE_TEXEL_COUNT = _texture::PAGE_SIZE * _texture::PAGE_SIZE;
+
+    static bool _is_paged(uint32_t width, uint32_t height) noexcept {
+        return width > _texture::PAGE_SIZE || height > _texture::PAGE_SIZE;
+    }
+
     _texture_engine &_texture_engine::get() noexcept {
         static _texture_engine engine;
         return engine;
     }
-    
-    size_t _texture_engine::create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void *data) noexcept {
-        size_t id;
-        do {
-            id = math::random((size_t)0, SIZE_MAX - 1) + 1;
-        } while (m_textures.find(id) != m_textures.cend());
 
-        m_textures[id] = _texture(width, height, channel_count, data);
+    _texture_engine::_texture_engine() noexcept
+        : m_loader_thread(&_texture_engine::_load_pages, this)
+    {
+    }
+
+    _texture_engine::~_texture_engine() {
+        {
+            std::scoped_lock<std::mutex> lock(m_page_mutex);
+            m_quit = true;
+        }
+
+        m_requested_cv.notify_one();
+        m_loader_thread.join();
+    }
     
-        return id;
+    size_t _texture_engine::create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void *data, bool generate_mipmaps, texture_format format) noexcept {
+        _texture texture(width, height, channel_count, data);
+        if (generate_mipmaps) {
+            _generate_mipmaps(texture);
+        }
+        _compress(texture, format);
+    
+        return m_textures.insert(std::move(texture));
+    }
+
+    size_t _texture_engine::create_compressed_texture(uint32_t width, uint32_t height, texture_format format, const void *blocks) noexcept {
+        ASSERT(format != texture_format::RGBA8, "texture engine error", "the format is not a compressed one");
+        _texture texture;
+        texture.width = width;
+        texture.height = height;
+        texture.channel_count = format == texture_format::BC1 ? 3 : 4;
+        
+        _texture::level& level = texture.levels.emplace_back();
+        level.format = format;
+        level.width = width;
+        level.height = height;
+        level.blocks_x = (width + _texture::BLOCK_SIZE - 1) / _texture::BLOCK_SIZE;
+
+        const size_t block_count = level.blocks_x * ((height + _texture::BLOCK_SIZE - 1) / _texture::BLOCK_SIZE);
+        const uint64_t* src = static_cast<const uint64_t*>(blocks);
+        level.blocks.assign(src, src + block_count * (format == texture_format::BC1 ? 1 : 2));
+
+        return m_textures.insert(std::move(texture));
+    }
+
+    bool _texture_engine::write_page_file(const char *filename, uint32_t width, uint32_t height, uint8_t channel_count, const void *data, uint64_t source_fingerprint) noexcept {
+        _texture texture(width, height, channel_count, data);
+        _generate_mipmaps(texture);
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        const _page_file_header header = { PAGE_FILE_MAGIC, width, height, channel_count, static_cast<uint32_t>(texture.levels.size()), source_fingerprint };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<uint32_t> page(PAGE_TEXEL_COUNT);
+        for (const _texture::level& level : texture.levels) {
+            if (!_is_paged(level.width, level.height)) {
+                file.write(reinterpret_cast<const char*>(level.texels.data()), level.texels.size() * sizeof(uint32_t));
+                continue;
+            }
+
+            for (uint32_t page_y = 0; page_y < level.height; page_y += _texture::PAGE_SIZE) {
+                for (uint32_t page_x = 0; page_x < level.width; page_x += _texture::PAGE_SIZE) {
+                    for (uint32_t y = 0; y < _texture::PAGE_SIZE; ++y) {
+                        for (uint32_t x = 0; x < _texture::PAGE_SIZE; ++x) {
+                            const uint32_t texel = level.texels[level.index(std::min(page_x + x, level.width - 1), std::min(page_y + y, level.height - 1))];
+                            page[_texture::blocked_index(x, y, _texture::PAGE_SIZE / _texture::BLOCK_SIZE)] = texel;
+                        }
+                    }
+                    file.write(reinterpret_cast<const char*>(page.data()), page.size() * sizeof(uint32_t));
+                }
+            }
+        }
+
+        return file.good();
+    }
+
+    size_t _texture_engine::create_virtual_texture(const char *filename, uint64_t source_fingerprint) noexcept {
+        std::unique_ptr<_mapped_file> file = std::make_unique<_mapped_file>();
+        if (!file->open(filename) || file->size() < sizeof(_page_file_header)) {
+            return 0;
+        }
+
+        _page_file_header header;
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (header.magic != PAGE_FILE_MAGIC || header.level_count == 0 || header.source_fingerprint != source_fingerprint) {
+            return 0;
+        }
+
+        _texture texture;
+        texture.width = header.width;
+        texture.height = header.height;
+        texture.channel_count = static_cast<uint8_t>(header.channel_count);
+
+        size_t offset = sizeof(header);
+        uint32_t width = header.width, height = header.height;
+
+        for (uint32_t i = 0; i < header.level_count; ++i) {
+            if (_is_paged(width, height)) {
+                _texture::level& level = texture.levels.emplace_back();
+                level.width = width;
+                level.height = height;
+                level.blocks_x = (width + _texture::BLOCK_SIZE - 1) / _texture::BLOCK_SIZE;
+                level.pages_x = (width + _texture::PAGE_SIZE - 1) / _texture::PAGE_SIZE;
+                
+                const size_t page_count = level.pages_x * ((height + _texture::PAGE_SIZE - 1) / _texture::PAGE_SIZE);
+                const size_t size = page_count * PAGE_TEXEL_COUNT * sizeof(uint32_t);
+                if (file->size() - offset < size) {
+                    return 0;
+                }
+
+                level.pages = std::make_unique<_texture::page[]>(page_count);
+                level.page_data = file->data() + offset;
+                offset += size;
+            } else {
+                _texture::level& level = texture.levels.emplace_back(width, height);
+
+                const size_t size = level.texels.size() * sizeof(uint32_t);
+                if (file->size() - offset < size) {
+                    return 0;
+                }
+
+                std::memcpy(level.texels.data(), file->data() + offset, size);
+                offset += size;
+            }
+
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+
+        // sampling falls back to the last level, it has to be resident
+        if (texture.levels.back().pages != nullptr) {
+            return 0;
+        }
+
+        m_page_files.emplace_back(std::move(file));
+        return m_textures.insert(std::move(texture));
+    }
+
+    size_t _texture_engine::create_render_texture(uint32_t width, uint32_t height, bool generate_mipmaps, texture_format format) noexcept {
+        ASSERT(format == texture_format::RGBA8 || format == texture_format::DEPTH32F, "texture engine error", "a render texture is RGBA8 or DEPTH32F");
+        ASSERT(!generate_mipmaps || format == texture_format::RGBA8, "texture engine error", "depth can not be averaged into mipmaps");
+        
+        _texture texture;
+        texture.width = width;
+        texture.height = height;
+        texture.channel_count = format == texture_format::DEPTH32F ? 1 : 4;
+        
+        _texture::level& level = texture.levels.emplace_back(width, height);
+        level.format = format;
+        
+        if (generate_mipmaps) {
+            _generate_mipmaps(texture);
+        }
+
+        return m_textures.insert(std::move(texture));
+    }
+
+    void _texture_engine::set_page_budget(size_t page_count) noexcept {
+        m_page_budget = page_count;
+    }
+
+    void _texture_engine::_request_page(const _texture::level& level, size_t page) noexcept {
+        {
+            std::scoped_lock<std::mutex> lock(m_page_mutex);
+            m_page_requests.push({ &level.pages[page], level.page_data + page * PAGE_TEXEL_COUNT * sizeof(uint32_t) });
+        }
+        m_requested_cv.notify_one();
+    }
+
+    void _texture_engine::_update_pages() noexcept {
+        ++m_frame;
+
+        {
+            std::scoped_lock<std::mutex> lock(m_page_mutex);
+            
+            for (_loaded_page& loaded : m_loaded_pages) {
+                loaded.page->texels.store(loaded.texels.get(), std::memory_order_release);
+                loaded.page->last_used = m_frame;
+                m_resident_pages.emplace_back(std::move(loaded));
+            }
+            m_loaded_pages.clear();
+        }
+
+        for (_loaded_page& resident : m_resident_pages) {
+            if (resident.page->used.exchange(false, std::memory_order_relaxed)) {
+                resident.page->last_used = m_frame;
+            }
+        }
+
+        if (m_resident_pages.size() <= m_page_budget) {
+            return;
+        }
+
+        // the pages of the last frame are kept even over the budget, evicting them would only have them requested again
+        std::sort(m_resident_pages.begin(), m_resident_pages.end(), [](const _loaded_page& a, const _loaded_page& b) {
+            return a.page->last_used > b.page->last_used;
+        });
+        
+        size_t kept = m_page_budget;
+        while (kept < m_resident_pages.size() && m_resident_pages[kept].page->last_used == m_frame) {
+            ++kept;
+        }
+
+        for (size_t i = kept; i < m_resident_pages.size(); ++i) {
+            m_resident_pages[i].page->texels.store(nullptr, std::memory_order_relaxed);
+            m_resident_pages[i].page->requested.store(false, std::memory_order_relaxed);
+        }
+        m_resident_pages.resize(kept);
+    }
+
+    void _texture_engine::_load_pages() noexcept {
+        while (true) {
+            _page_request request;
+            
+            {
+                std::unique_lock<std::mutex> lock(m_page_mutex);
+                m_requested_cv.wait(lock, [this]() { return m_quit || !m_page_requests.empty(); });
+
+                if (m_quit) {
+                    return;
+                }
+
+                request = m_page_requests.front();
+                m_page_requests.pop();
+            }
+
+            // reading the mapping is what brings the page in from the disk, so it is done out of the lock
+            std::unique_ptr<uint32_t[]> texels = std::make_unique<uint32_t[]>(PAGE_TEXEL_COUNT);
+            std::memcpy(texels.get(), request.data, PAGE_TEXEL_COUNT * sizeof(uint32_t));
+
+            {
+                std::scoped_lock<std::mutex> lock(m_page_mutex);
+                m_loaded_pages.push_back({ request.page, std::move(texels) });
+            }
+        }
+    }
+
+    void _texture_engine::_update_render_texture(size_t id, const uint32_t* texels) noexcept {
+        _ASSERT_TEXTURE_ID_VALIDITY(m_textures, id);
+        _texture& texture = m_textures.get(id);
+        _texture::level& base = texture.levels[0];
+
+        for (uint32_t block_y = 0; block_y < base.height; block_y += _texture::BLOCK_SIZE) {
+            m_thread_pool.AddTask([&base, texels, block_y]() {
+                for (uint32_t y = block_y; y < std::min(block_y + _texture::BLOCK_SIZE, base.height); ++y) {
+                    for (uint32_t x = 0; x < base.width; ++x) {
+                        base.texels[base.index(x, y)] = texels[x + y * base.width];
+                    }
+                }
+            });
+        }
+        m_thread_pool.WaitAll();
+
+        for (size_t level = 1; level < texture.levels.size(); ++level) {
+            _downsample(texture.levels[level - 1], texture.levels[level]);
+        }
+    }
+
+    void _texture_engine::_generate_mipmaps(_texture& texture) noexcept {
+        while (texture.levels.back().width > 1 || texture.levels.back().height > 1) {
+            const uint32_t width = std::max(texture.levels.back().width / 2, 1u), height = std::max(texture.levels.back().height / 2, 1u);
+            texture.levels.emplace_back(width, height);
+            
+            _downsample(texture.levels[texture.levels.size() - 2], texture.levels.back());
+        }
+    }
+
+    void _texture_engine::_downsample(const _texture::level& prev, _texture::level& dst) noexcept {
+        // every texel averages its 2x2 footprint in the previous level, an odd last row or column is folded in by clamping
+        for (uint32_t block_y = 0; block_y < dst.height; block_y += _texture::BLOCK_SIZE) {
+            m_thread_pool.AddTask([&prev, &dst, block_y]() {
+                for (uint32_t y = block_y; y < std::min(block_y + _texture::BLOCK_SIZE, dst.height); ++y) {
+                    const uint32_t y0 = 2 * y, y1 = std::min(2 * y + 1, prev.height - 1);
+                    
+                    for (uint32_t x = 0; x < dst.width; ++x) {
+                        const uint32_t x0 = 2 * x, x1 = std::min(2 * x + 1, prev.width - 1);
+                        const uint32_t texels[4] = { 
+                            prev.texels[prev.index(x0, y0)], prev.texels[prev.index(x1, y0)], 
+                            prev.texels[prev.index(x0, y1)], prev.texels[prev.index(x1, y1)] 
+                        };
+
+                        uint32_t result = 0;
+                        for (uint32_t shift = 0; shift < 32; shift += 8) {
+                            const uint32_t sum = ((texels[0] >> shift) & 0xFF) + ((texels[1] >> shift) & 0xFF) + ((texels[2] >> shift) & 0xFF) + ((texels[3] >> shift) & 0xFF);
+                            result |= ((sum + 2) / 4) << shift;
+                        }
+                        dst.texels[dst.index(x, y)] = result;
+                    }
+                }
+            });
+        }
+
+        m_thread_pool.WaitAll();
+    }
+
+    void _texture_engine::_compress(_texture& texture, texture_format format) noexcept {
+        if (format == texture_format::RGBA8) {
+            return;
+        }
+
+        for (_texture::level& level : texture.levels) {
+            const size_t blocks_y = (level.height + _texture::BLOCK_SIZE - 1) / _texture::BLOCK_SIZE;
+            level.blocks.resize(level.blocks_x * blocks_y * (format == texture_format::BC1 ? 1 : 2));
+
+            for (size_t block_y = 0; block_y < blocks_y; ++block_y) {
+                m_thread_pool.AddTask([&level, format, block_y]() {
+                    for (size_t block = block_y * level.blocks_x; block < (block_y + 1) * level.blocks_x; ++block) {
+                        level.encode_block(format, block);
+                    }
+                });
+            }
+            m_thread_pool.WaitAll();
+
+            level.format = format;
+            level.texels = std::vector<uint32_t>();
+        }
     }
     
     void _texture_engine::bind_texture(size_t id) noexcept {
@@ -30,11 +366,17 @@ namespace gl {
 
     void _texture_engine::activate_texture(size_t slot) noexcept {
         _ASSERT_TEXTURE_ID_VALIDITY(m_textures, m_binded_texture);
+        _ASSERT_TEXTURE_SLOT_VALIDITY(m_texture_slots, slot);
         m_texture_slots[slot] = m_binded_texture;
     }
 
     const _texture &_texture_engine::_get_slot(size_t slot) const noexcept {
         _ASSERT_TEXTURE_SLOT_VALIDITY(m_texture_slots, slot);
-        return m_textures.at(m_texture_slots.at(slot));
+        return m_textures.get(m_texture_slots[slot]);
+    }
+
+    const _texture &_texture_engine::_get_texture(size_t id) const noexcept {
+        _ASSERT_TEXTURE_ID_VALIDITY(m_textures, id);
+        return m_textures.get(id);
     }
 }
\ No newline at end of file
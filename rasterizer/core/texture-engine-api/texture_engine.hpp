@@ -1,26 +1,111 @@
 #pragma once
-#include <unordered_map>
 #include "texture.hpp"
+#include "mapped_file.hpp"
+#include "core/slot_map.hpp"
+
+#include <condition_variable>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <queue>
+
+#include "thread_pool/thread_pool.hpp"
 
 namespace gl {
     class _texture_engine final {
     public:
+        _texture_engine(const _texture_engine& engine) = delete;
+        _texture_engine& operator=(const _texture_engine& engine) = delete;
+
         static _texture_engine& get() noexcept;
 
-        size_t create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void* data) noexcept;
+        ~_texture_engine();
+
+        /**
+         * 'generate_mipmaps' builds the whole mip chain with a box filter, a level is split between the workers by block rows. 
+         * Every level is then compressed to 'format' the same way.
+        */
+        size_t create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void* data, bool generate_mipmaps = false, 
+            texture_format format = texture_format::RGBA8) noexcept;
+        // 'blocks' are BC1 or BC3 blocks of a single level, row by row, as they are stored in DDS files
+        size_t create_compressed_texture(uint32_t width, uint32_t height, texture_format format, const void* blocks) noexcept;
+        /**
+         * Bakes the image and its whole mip chain into a page file for create_virtual_texture. It takes the whole 
+         * image in memory, so it is meant to be done once, ahead of the runs that use the file. 'source_fingerprint' 
+         * identifies the image, e.g. its file's size and write time, and is stored in the file.
+        */
+        bool write_page_file(const char* filename, uint32_t width, uint32_t height, uint8_t channel_count, const void* data, 
+            uint64_t source_fingerprint = 0) noexcept;
+        /**
+         * Maps the page file, only the levels that fit in a page are read up front. The pages of the larger levels are 
+         * requested by the sampler and read from the mapping by a loader thread, meanwhile sampling falls back to coarser 
+         * levels. Loaded pages are made resident and unused ones evicted by swap_buffers. Returns 0 if the file is not a page file 
+         * or was baked from an image other than 'source_fingerprint' tells, so a stale file is to be baked again.
+        */
+        size_t create_virtual_texture(const char* filename, uint64_t source_fingerprint = 0) noexcept;
+        /**
+         * An RGBA8 or DEPTH32F texture to attach to a framebuffer, see _render_engine::attach_color_texture. Its texels 
+         * are replaced by the framebuffer's whenever that is unbound, along with the mip chain if there is one.
+        */
+        size_t create_render_texture(uint32_t width, uint32_t height, bool generate_mipmaps = false, texture_format format = texture_format::RGBA8) noexcept;
+        // the number of pages kept resident over all virtual textures, the least recently used ones go first
+        void set_page_budget(size_t page_count) noexcept;
         void bind_texture(size_t id) noexcept;
         void activate_texture(size_t slot = 0) noexcept;
 
     public:
         const _texture& _get_slot(size_t id) const noexcept;
+        const _texture& _get_texture(size_t id) const noexcept;
+
+        void _request_page(const _texture::level& level, size_t page) noexcept;
+        // between frames only, while nothing samples the textures
+        void _update_pages() noexcept;
+        // 'texels' are width * height words, row by row from the top, as the render texture's format packs them
+        void _update_render_texture(size_t id, const uint32_t* texels) noexcept;
 
     private:
-        _texture_engine() = default;
+        _texture_engine() noexcept;
+
+        void _generate_mipmaps(_texture& texture) noexcept;
+        void _downsample(const _texture::level& src, _texture::level& dst) noexcept;
+        void _compress(_texture& texture, texture_format format) noexcept;
+
+        void _load_pages() noexcept;
 
     private:
-        std::unordered_map<size_t, size_t> m_texture_slots;
+        static constexpr size_t MAX_TEXTURE_SLOTS = 16;
+        // the texture activated in every slot, looked up by every sampler_2D call
+        std::array<size_t, MAX_TEXTURE_SLOTS> m_texture_slots = {};
 
-        std::unordered_map<size_t, _texture> m_textures;
+        _slot_map<_texture> m_textures;
         size_t m_binded_texture = 0;
+
+        util::ThreadPool m_thread_pool = { std::max(std::thread::hardware_concurrency(), 1u) };
+
+        struct _page_request {
+            _texture::page* page;
+            const uint8_t* data;
+        };
+
+        struct _loaded_page {
+            _texture::page* page;
+            std::unique_ptr<uint32_t[]> texels;
+        };
+
+        // mapped for as long as the engine lives, the virtual textures read their pages from them
+        std::vector<std::unique_ptr<_mapped_file>> m_page_files;
+
+        std::queue<_page_request> m_page_requests;
+        // loaded by the loader thread, not yet visible to the sampler
+        std::vector<_loaded_page> m_loaded_pages;
+        std::vector<_loaded_page> m_resident_pages;
+        size_t m_page_budget = 1024;
+        uint32_t m_frame = 0;
+        bool m_quit = false;
+
+        std::mutex m_page_mutex;
+        std::condition_variable m_requested_cv;
+
+        std::thread m_loader_thread;
     };
 }
\ No newline at end of file
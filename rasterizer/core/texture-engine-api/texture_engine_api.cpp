@@ -6,8 +6,28 @@ namespace gl {
     {
     }
     
-    size_t _texture_engine_api::create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void *data) const noexcept {
-        return m_tex_engine.create_texture(width, height, channel_count, data);
+    size_t _texture_engine_api::create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void *data, bool generate_mipmaps, texture_format format) const noexcept {
+        return m_tex_engine.create_texture(width, height, channel_count, data, generate_mipmaps, format);
+    }
+
+    size_t _texture_engine_api::create_compressed_texture(uint32_t width, uint32_t height, texture_format format, const void *blocks) const noexcept {
+        return m_tex_engine.create_compressed_texture(width, height, format, blocks);
+    }
+
+    bool _texture_engine_api::write_page_file(const char *filename, uint32_t width, uint32_t height, uint8_t channel_count, const void *data, uint64_t source_fingerprint) const noexcept {
+        return m_tex_engine.write_page_file(filename, width, height, channel_count, data, source_fingerprint);
+    }
+
+    size_t _texture_engine_api::create_virtual_texture(const char *filename, uint64_t source_fingerprint) const noexcept {
+        return m_tex_engine.create_virtual_texture(filename, source_fingerprint);
+    }
+
+    size_t _texture_engine_api::create_render_texture(uint32_t width, uint32_t height, bool generate_mipmaps, texture_format format) const noexcept {
+        return m_tex_engine.create_render_texture(width, height, generate_mipmaps, format);
+    }
+
+    void _texture_engine_api::set_page_budget(size_t page_count) const noexcept {
+        m_tex_engine.set_page_budget(page_count);
     }
     
     void _texture_engine_api::bind_texture(size_t id) const noexcept {
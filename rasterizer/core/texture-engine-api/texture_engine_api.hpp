@@ -6,7 +6,14 @@ namespace gl {
     public:
         _texture_engine_api();
 
-        size_t create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void* data) const noexcept;
+        size_t create_texture(uint32_t width, uint32_t height, uint8_t channel_count, const void* data, bool generate_mipmaps = false, 
+            texture_format format = texture_format::RGBA8) const noexcept;
+        size_t create_compressed_texture(uint32_t width, uint32_t height, texture_format format, const void* blocks) const noexcept;
+        bool write_page_file(const char* filename, uint32_t width, uint32_t height, uint8_t channel_count, const void* data, 
+            uint64_t source_fingerprint = 0) const noexcept;
+        size_t create_virtual_texture(const char* filename, uint64_t source_fingerprint = 0) const noexcept;
+        size_t create_render_texture(uint32_t width, uint32_t height, bool generate_mipmaps = false, texture_format format = texture_format::RGBA8) const noexcept;
+        void set_page_budget(size_t page_count) const noexcept;
         void bind_texture(size_t id) const noexcept;
         void activate_texture(size_t slot = 0) const noexcept;
 
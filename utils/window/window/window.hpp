@@ -77,6 +77,7 @@ namespace win_framewrk {
         bool IsOpen() const noexcept;
         void FillPixelBuffer(const std::vector<uint32_t>& pixels) const noexcept;
         void FillPixelBuffer(uint8_t r, uint8_t g, uint8_t b, uint8_t a) const noexcept;
+        // the surface is not cleared afterwards, the next FillPixelBuffer overwrites all of it
         void PresentPixelBuffer() const noexcept;
         void PollEvent() noexcept;
 